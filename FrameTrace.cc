@@ -0,0 +1,199 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "FrameTrace.h"
+
+namespace lte {
+
+static const char frameTraceMagic[8] = { 'L', 'T', 'E', 'T', 'R', 'A', 'C', 'E' };
+static const uint32_t frameTraceVersion = 2;
+
+template<typename T>
+static void append(std::vector<char>& buffer, const T& value)
+{
+    auto bytes = reinterpret_cast<const char *>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+FrameTraceWriter::FrameTraceWriter(const char *fileName)
+{
+    // every run starts a new trace, the stream is flushed when the writer is destroyed
+    stream.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!stream.is_open())
+        throw cRuntimeError("Cannot open frame trace file: %s", fileName);
+    FrameTraceFileHeader header;
+    memcpy(header.magic, frameTraceMagic, sizeof(header.magic));
+    header.version = frameTraceVersion;
+    header.reserved = 0;
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+void FrameTraceWriter::writeFrame(simtime_t startTime, const Frame& frame)
+{
+    const auto& grid = frame.getGrid();
+    const auto& mode = grid.getMode();
+    buffer.clear();
+    FrameTraceRecordHeader header;
+    header.recordLength = 0; // filled in at the end
+    header.slotIndex = frame.getSlotIndex();
+    header.startTime = startTime.inUnit(SIMTIME_PS);
+    header.frameLength = frame.getTotalLength().get();
+    header.bandwidth = (uint8_t)mode.getChannelBandwidth();
+    header.cyclicPrefix = (uint8_t)mode.getCyclicPrefix();
+    header.modulation = (uint8_t)mode.getModulation();
+    header.levelOfDetail = (uint8_t)grid.getLevelOfDetail();
+    header.numAllocations = grid.getAllocations().size();
+    header.codeRate = mode.getCodeRate();
+    header.reserved = 0;
+    append(buffer, header);
+    for (const auto& allocation : grid.getAllocations()) {
+        FrameTraceAllocation traceAllocation;
+        traceAllocation.source = allocation.source.getInt();
+        traceAllocation.destination = allocation.destination.getInt();
+        traceAllocation.numResourceBlocks = allocation.resourceBlocks.size();
+        traceAllocation.numSegments = allocation.segments.size();
+        append(buffer, traceAllocation);
+        for (const auto& allocatedResourceBlock : allocation.resourceBlocks) {
+            FrameTraceResourceBlock traceResourceBlock;
+            traceResourceBlock.subframeIndex = allocatedResourceBlock.subframeIndex;
+            traceResourceBlock.slotIndex = allocatedResourceBlock.slotIndex;
+            traceResourceBlock.resourceBlockIndex = allocatedResourceBlock.resourceBlockIndex;
+            append(buffer, traceResourceBlock);
+        }
+        for (const auto& segment : allocation.segments) {
+            FrameTraceSegment traceSegment;
+            traceSegment.offset = segment.offset.get();
+            traceSegment.length = segment.length.get();
+            traceSegment.packetLength = segment.packetLength.get();
+            append(buffer, traceSegment);
+        }
+    }
+    uint32_t recordLength = buffer.size();
+    memcpy(buffer.data() + offsetof(FrameTraceRecordHeader, recordLength), &recordLength, sizeof(recordLength));
+    // a record is written at once, so a partially written trace can only be truncated at its end
+    stream.write(buffer.data(), buffer.size());
+}
+
+FrameTraceReader::FrameTraceReader(const char *fileName)
+{
+    int fd = open(fileName, O_RDONLY);
+    if (fd == -1)
+        throw cRuntimeError("Cannot open frame trace file: %s", fileName);
+    struct stat fileStatus;
+    if (fstat(fd, &fileStatus) == -1) {
+        close(fd);
+        throw cRuntimeError("Cannot determine the size of frame trace file: %s", fileName);
+    }
+    size = fileStatus.st_size;
+    if (size > 0) {
+        void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw cRuntimeError("Cannot map frame trace file: %s", fileName);
+        }
+        data = static_cast<const char *>(mapping);
+    }
+    // the mapping stays valid after the file is closed
+    close(fd);
+    FrameTraceFileHeader header;
+    memcpy(&header, read(sizeof(header)), sizeof(header));
+    if (memcmp(header.magic, frameTraceMagic, sizeof(header.magic)) || header.version != frameTraceVersion)
+        throw cRuntimeError("Unsupported frame trace file: %s", fileName);
+}
+
+FrameTraceReader::~FrameTraceReader()
+{
+    if (data != nullptr)
+        munmap(const_cast<char *>(data), size);
+}
+
+const char *FrameTraceReader::read(size_t length)
+{
+    if (position + length > size)
+        throw cRuntimeError("Truncated frame trace at offset %lu", (unsigned long)position);
+    auto result = data + position;
+    position += length;
+    return result;
+}
+
+simtime_t FrameTraceReader::getNextFrameStartTime() const
+{
+    FrameTraceRecordHeader header;
+    if (position + sizeof(header) > size)
+        throw cRuntimeError("Truncated frame trace at offset %lu", (unsigned long)position);
+    memcpy(&header, data + position, sizeof(header));
+    return SimTime(header.startTime, SIMTIME_PS);
+}
+
+void FrameTraceReader::readFrame(FrameTraceRecord& record)
+{
+    size_t recordPosition = position;
+    FrameTraceRecordHeader header;
+    memcpy(&header, read(sizeof(header)), sizeof(header));
+    if (header.bandwidth > (uint8_t)LteBandwidth::MHZ_20 || header.cyclicPrefix > (uint8_t)LteCyclicPrefix::EXTENDED || header.modulation > (uint8_t)LteModulation::QAM64 || header.levelOfDetail > (uint8_t)LevelOfDetail::RESOURCE_ELEMENT || header.codeRate == 0 || header.codeRate >= 1024)
+        throw cRuntimeError("Invalid frame trace record at offset %lu", (unsigned long)recordPosition);
+    size_t recordEnd = recordPosition + header.recordLength;
+    if (header.recordLength < sizeof(header) || recordEnd > size)
+        throw cRuntimeError("Invalid record length %lu in frame trace record at offset %lu", (unsigned long)header.recordLength, (unsigned long)recordPosition);
+    record.startTime = SimTime(header.startTime, SIMTIME_PS);
+    record.slotIndex = header.slotIndex;
+    record.frameLength = b(header.frameLength);
+    record.mode = LteMode((LteBandwidth)header.bandwidth, (LteCyclicPrefix)header.cyclicPrefix, (LteModulation)header.modulation, header.codeRate);
+    const auto& mode = record.mode;
+    if (mode.getResourceBlockLength() == b(0))
+        throw cRuntimeError("Invalid code rate %lu in frame trace record at offset %lu", (unsigned long)header.codeRate, (unsigned long)recordPosition);
+    if (header.slotIndex < -1 || header.slotIndex >= mode.getNumSlotsPerFrame())
+        throw cRuntimeError("Invalid slot index %d in frame trace record at offset %lu", (int)header.slotIndex, (unsigned long)recordPosition);
+    record.levelOfDetail = (LevelOfDetail)header.levelOfDetail;
+    // the counts are checked against the rest of the record before anything is allocated for them
+    if ((uint64_t)header.numAllocations * sizeof(FrameTraceAllocation) > recordEnd - position)
+        throw cRuntimeError("Invalid allocation count %lu in frame trace record at offset %lu", (unsigned long)header.numAllocations, (unsigned long)recordPosition);
+    record.allocations.resize(header.numAllocations);
+    for (auto& allocation : record.allocations) {
+        FrameTraceAllocation traceAllocation;
+        memcpy(&traceAllocation, read(sizeof(traceAllocation)), sizeof(traceAllocation));
+        allocation.source = MacAddress(traceAllocation.source);
+        allocation.destination = MacAddress(traceAllocation.destination);
+        if (position > recordEnd || (uint64_t)traceAllocation.numResourceBlocks * sizeof(FrameTraceResourceBlock) + (uint64_t)traceAllocation.numSegments * sizeof(FrameTraceSegment) > recordEnd - position)
+            throw cRuntimeError("Invalid resource block or segment count in frame trace record at offset %lu", (unsigned long)recordPosition);
+        allocation.resourceBlocks.resize(traceAllocation.numResourceBlocks);
+        for (auto& allocatedResourceBlock : allocation.resourceBlocks) {
+            FrameTraceResourceBlock traceResourceBlock;
+            memcpy(&traceResourceBlock, read(sizeof(traceResourceBlock)), sizeof(traceResourceBlock));
+            if (traceResourceBlock.subframeIndex >= mode.getNumSubframesPerFrame() || traceResourceBlock.slotIndex >= mode.getNumSlotsPerSubframe() || traceResourceBlock.resourceBlockIndex >= mode.getNumResourceBlocksPerSlot())
+                throw cRuntimeError("Invalid resource block %d/%d/%d in frame trace record at offset %lu", (int)traceResourceBlock.subframeIndex, (int)traceResourceBlock.slotIndex, (int)traceResourceBlock.resourceBlockIndex, (unsigned long)recordPosition);
+            allocatedResourceBlock.subframeIndex = traceResourceBlock.subframeIndex;
+            allocatedResourceBlock.slotIndex = traceResourceBlock.slotIndex;
+            allocatedResourceBlock.resourceBlockIndex = traceResourceBlock.resourceBlockIndex;
+        }
+        allocation.segments.resize(traceAllocation.numSegments);
+        for (auto& segment : allocation.segments) {
+            FrameTraceSegment traceSegment;
+            memcpy(&traceSegment, read(sizeof(traceSegment)), sizeof(traceSegment));
+            segment.offset = b(traceSegment.offset);
+            segment.length = b(traceSegment.length);
+            segment.packetLength = b(traceSegment.packetLength);
+        }
+    }
+    if (position != recordPosition + header.recordLength)
+        throw cRuntimeError("Invalid frame trace record at offset %lu", (unsigned long)recordPosition);
+}
+
+} // namespace lte
@@ -0,0 +1,121 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+#ifndef __LTE_FRAMETRACE_H_
+#define __LTE_FRAMETRACE_H_
+
+#include <fstream>
+#include "Phy.h"
+
+namespace lte {
+
+/**
+ * The binary frame trace starts with this header, followed by the frame
+ * records. Every record consists of a FrameTraceRecordHeader followed by its
+ * allocations, and every allocation consists of a FrameTraceAllocation
+ * followed by its resource blocks and segments. All fields are stored in the
+ * native byte order without padding between the structures.
+ */
+struct FrameTraceFileHeader {
+    char magic[8]; // "LTETRACE"
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct FrameTraceRecordHeader {
+    uint32_t recordLength; // in bytes including this header
+    int32_t slotIndex; // -1 means the whole frame
+    int64_t startTime; // in picoseconds
+    uint64_t frameLength; // in bits
+    uint8_t bandwidth;
+    uint8_t cyclicPrefix;
+    uint8_t modulation;
+    uint8_t levelOfDetail;
+    uint32_t numAllocations;
+    uint32_t codeRate; // in 1/1024 units
+    uint32_t reserved;
+};
+
+struct FrameTraceAllocation {
+    uint64_t source;
+    uint64_t destination;
+    uint32_t numResourceBlocks;
+    uint32_t numSegments;
+};
+
+struct FrameTraceResourceBlock {
+    uint8_t subframeIndex;
+    uint8_t slotIndex;
+    uint16_t resourceBlockIndex;
+};
+
+struct FrameTraceSegment {
+    uint64_t offset; // in bits
+    uint64_t length; // in bits
+    uint64_t packetLength; // in bits
+};
+
+/**
+ * Represents a frame read from the binary frame trace. Only the resource
+ * block allocation and the content lengths are recorded, not the content.
+ */
+class FrameTraceRecord {
+  public:
+    simtime_t startTime;
+    int slotIndex = -1;
+    b frameLength = b(0);
+    LteMode mode;
+    LevelOfDetail levelOfDetail = LevelOfDetail::RESOURCE_BLOCK;
+    std::vector<ResourceAllocation> allocations;
+};
+
+/**
+ * Writes the transmitted frames to a binary frame trace file. An existing file
+ * is overwritten.
+ */
+class FrameTraceWriter {
+  protected:
+    std::ofstream stream;
+    std::vector<char> buffer; // reused for every record
+
+  public:
+    FrameTraceWriter(const char *fileName);
+
+    void writeFrame(simtime_t startTime, const Frame& frame);
+};
+
+/**
+ * Reads the frames from a binary frame trace file which is mapped into memory.
+ */
+class FrameTraceReader {
+  protected:
+    const char *data = nullptr;
+    size_t size = 0;
+    size_t position = 0;
+
+  protected:
+    const char *read(size_t length);
+
+  public:
+    FrameTraceReader(const char *fileName);
+    ~FrameTraceReader();
+
+    bool hasNextFrame() const { return position < size; }
+    simtime_t getNextFrameStartTime() const;
+    void readFrame(FrameTraceRecord& record);
+};
+
+} // namespace lte
+
+#endif // __LTE_FRAMETRACE_H_
@@ -13,28 +13,82 @@
 // along with this program.  If not, see http://www.gnu.org/licenses/.
 //
 
-#include "inet/common/packet/chunk/SequenceChunk.h"
+#include <algorithm>
+#include <cstdlib>
+#include "inet/common/ModuleAccess.h"
 #include "inet/common/ProtocolTag_m.h"
+#include "inet/common/packet/chunk/BitCountChunk.h"
+#include "inet/linklayer/common/MacAddressTag_m.h"
+#include "inet/networklayer/common/InterfaceEntry.h"
+#include "inet/physicallayer/analogmodel/packetlevel/ScalarNoise.h"
+#include "inet/physicallayer/analogmodel/packetlevel/ScalarReception.h"
 #include "inet/physicallayer/common/packetlevel/BandListening.h"
 #include "inet/physicallayer/common/packetlevel/ListeningDecision.h"
 #include "Phy.h"
+#include "FrameTrace.h"
+#include "Scheduler.h"
+#include "WorkerPool.h"
 
 namespace lte {
 
 Define_Module(LteTransmitter);
 Define_Module(LteReceiver);
+Define_Module(LteErrorModel);
 Define_Module(LteRadio);
+Define_Module(LteRadioMedium);
 Protocol lte("lte", "LTE");
 
+simsignal_t LteRadio::resourceBlockUtilizationSignal = cComponent::registerSignal("resourceBlockUtilization");
+simsignal_t LteRadio::frameLengthSignal = cComponent::registerSignal("frameLength");
+simsignal_t LteRadio::packetSegmentsSignal = cComponent::registerSignal("packetSegments");
+simsignal_t LteRadio::packetChunksSignal = cComponent::registerSignal("packetChunks");
+simsignal_t LteRadio::transmitFrameTimeSignal = cComponent::registerSignal("transmitFrameTime");
+simsignal_t LteRadio::sendUpTimeSignal = cComponent::registerSignal("sendUpTime");
+
+void LteTransmitter::initialize(int stage)
+{
+    TransmitterBase::initialize(stage);
+    if (stage == INITSTAGE_LOCAL) {
+        power = W(par("power"));
+        carrierFrequency = Hz(par("carrierFrequency"));
+    }
+}
+
 const ITransmission *LteTransmitter::createTransmission(const IRadio *transmitter, const Packet *packet, const simtime_t startTime) const
 {
+    const auto& grid = check_and_cast<const Frame *>(packet)->getGrid();
+    const auto& mode = grid.getMode();
+    // the frequency bounds of the signal are the bounds of the allocated resource blocks
+    int minResourceBlockIndex = mode.getNumResourceBlocksPerSlot();
+    int maxResourceBlockIndex = -1;
+    for (const auto& allocation : grid.getAllocations()) {
+        for (const auto& allocatedResourceBlock : allocation.resourceBlocks) {
+            minResourceBlockIndex = std::min(minResourceBlockIndex, allocatedResourceBlock.resourceBlockIndex);
+            maxResourceBlockIndex = std::max(maxResourceBlockIndex, allocatedResourceBlock.resourceBlockIndex);
+        }
+    }
+    auto minFrequency = carrierFrequency - mode.getBandwidth() / 2 + mode.getResourceBlockBandwidth() * minResourceBlockIndex;
+    auto maxFrequency = carrierFrequency - mode.getBandwidth() / 2 + mode.getResourceBlockBandwidth() * (maxResourceBlockIndex + 1);
     auto endTime = startTime + packet->getDuration();
     auto mobility = transmitter->getAntenna()->getMobility();
     auto startPosition = mobility->getCurrentPosition();
     auto endPosition = mobility->getCurrentPosition();
     auto startOrientation = mobility->getCurrentAngularPosition();
     auto endOrientation = mobility->getCurrentAngularPosition();
-    return new LteTransmission(transmitter, packet, startTime, endTime, startPosition, endPosition, startOrientation, endOrientation);
+    return new LteTransmission(transmitter, packet, startTime, endTime, startPosition, endPosition, startOrientation, endOrientation, power, carrierFrequency, mode.getBandwidth(), minFrequency, maxFrequency);
+}
+
+void LteReceiver::initialize(int stage)
+{
+    ReceiverBase::initialize(stage);
+    if (stage == INITSTAGE_LOCAL) {
+        snirThreshold = math::dB2fraction(par("snirThreshold"));
+        auto errorModelModule = getSubmodule("errorModel");
+        errorModel = errorModelModule != nullptr ? check_and_cast<LteErrorModel *>(errorModelModule) : nullptr;
+        // derived from the seed set instead of drawn from a random number generator to keep its stream intact
+        uint64_t seedSet = std::strtoull(getEnvir()->getConfigEx()->getVariable(CFGVAR_SEEDSET), nullptr, 10);
+        randomSeed = (seedSet << 32) ^ (uint64_t)getId();
+    }
 }
 
 const IListening *LteReceiver::createListening(const IRadio *radio, const simtime_t startTime, const simtime_t endTime, const Coord startPosition, const Coord endPosition) const
@@ -47,149 +101,1404 @@ const IListeningDecision *LteReceiver::computeListeningDecision(const IListening
     return new ListeningDecision(listening, true);
 }
 
+bool LteReceiver::computeIsReceptionPossible(const IListening *listening, const IReception *reception, IRadioSignal::SignalPart part) const
+{
+    // other technologies sharing the medium only interfere
+    auto frame = dynamic_cast<const Frame *>(reception->getTransmission()->getPacket());
+    if (frame == nullptr)
+        return false;
+    auto radio = dynamic_cast<const LteRadio *>(listening->getReceiver());
+    auto address = radio != nullptr ? radio->getAddress() : MacAddress::UNSPECIFIED_ADDRESS;
+    if (address.isUnspecified())
+        return true;
+    const auto& grid = frame->getGrid();
+    for (const auto& allocation : grid.getAllocations())
+        if (allocation.destination == address || allocation.destination.isMulticast())
+            return true;
+    return false;
+}
+
 bool LteReceiver::computeIsReceptionSuccessful(const IListening *listening, const IReception *reception, IRadioSignal::SignalPart part, const IInterference *interference, const ISnir *snir) const
 {
     return true;
 }
 
-LteRadio::LteRadio()
+const IReceptionResult *LteReceiver::computeReceptionResult(const IListening *listening, const IReception *reception, const IInterference *interference, const ISnir *snir, const std::vector<const IReceptionDecision *> *decisions) const
+{
+    auto receptionResult = ReceiverBase::computeReceptionResult(listening, reception, interference, snir, decisions);
+    auto frame = dynamic_cast<Frame *>(const_cast<Packet *>(receptionResult->getPacket()));
+    if (frame == nullptr)
+        return receptionResult;
+    auto radio = listening->getReceiver();
+    auto medium = dynamic_cast<const LteRadioMedium *>(radio->getMedium());
+    std::vector<bool> erroneousResourceBlocks;
+    if (medium == nullptr || !medium->takeErroneousResourceBlocks(radio, reception->getTransmission(), erroneousResourceBlocks))
+        computeErroneousResourceBlocks(reception, interference, erroneousResourceBlocks);
+    if (std::find(erroneousResourceBlocks.begin(), erroneousResourceBlocks.end(), true) != erroneousResourceBlocks.end())
+        frame->setErroneousResourceBlocks(erroneousResourceBlocks);
+    return receptionResult;
+}
+
+void LteReceiver::computeErroneousResourceBlocks(const IReception *reception, const IInterference *interference, std::vector<bool>& erroneousResourceBlocks) const
+{
+    auto transmission = reception->getTransmission();
+    std::vector<double> snirs;
+    computeResourceBlockSnirs(reception, interference, snirs);
+    computeErroneousResourceBlocks(check_and_cast<const Frame *>(transmission->getPacket()), transmission->getId(), snirs, erroneousResourceBlocks);
+}
+
+void LteReceiver::computeErroneousResourceBlocks(const Frame *frame, int transmissionId, const std::vector<double>& snirs, std::vector<bool>& erroneousResourceBlocks) const
+{
+    const auto& grid = frame->getGrid();
+    const auto& mode = grid.getMode();
+    double referenceSnir = errorModel != nullptr ? LteErrorModel::computeReferenceSnir(mode.getModulation(), mode.getCodeRate()) : NaN;
+    erroneousResourceBlocks.assign(snirs.size(), false);
+    // the block error rates are only looked up for the allocated resource blocks above the threshold
+    for (const auto& allocation : grid.getAllocations()) {
+        for (const auto& allocatedResourceBlock : allocation.resourceBlocks) {
+            int i = grid.getSlotIndex(allocatedResourceBlock.subframeIndex, allocatedResourceBlock.slotIndex) * mode.getNumResourceBlocksPerSlot() + allocatedResourceBlock.resourceBlockIndex;
+            if (snirs[i] < snirThreshold)
+                erroneousResourceBlocks[i] = true;
+            else if (errorModel != nullptr) {
+                double errorRate = errorModel->lookupBlockErrorRate(referenceSnir, snirs[i]);
+                erroneousResourceBlocks[i] = errorRate > 0 && computeUniform(transmissionId, i) < errorRate;
+            }
+        }
+    }
+}
+
+double LteReceiver::computeUniform(int transmissionId, int resourceBlockIndex) const
+{
+    // SplitMix64 finalizer applied to the combined counter
+    uint64_t z = randomSeed + (((uint64_t)transmissionId << 16) + resourceBlockIndex + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    return (z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void LteReceiver::computeResourceBlockSnirs(const IReception *reception, const IInterference *interference, std::vector<double>& snirs) const
+{
+    auto transmission = check_and_cast<const LteTransmission *>(reception->getTransmission());
+    auto frame = check_and_cast<const Frame *>(transmission->getPacket());
+    const auto& grid = frame->getGrid();
+    const auto& mode = grid.getMode();
+    int numResourceBlocks = mode.getNumResourceBlocksPerSlot();
+    double startTime = (reception->getStartTime() - frame->getSignalOffset()).dbl();
+    double minFrequency = (transmission->getCarrierFrequency() - mode.getBandwidth() / 2).get();
+    double maxFrequency = minFrequency + mode.getBandwidth().get();
+    double signalPower = check_and_cast<const ScalarReception *>(reception)->getPower().get() / numResourceBlocks;
+    // the background noise is considered to be evenly distributed among the resource blocks
+    double noisePower = 0;
+    auto backgroundNoise = dynamic_cast<const ScalarNoise *>(interference->getBackgroundNoise());
+    if (backgroundNoise != nullptr)
+        noisePower = backgroundNoise->computeMaxPower(reception->getStartTime(), reception->getEndTime()).get() / numResourceBlocks;
+    std::vector<double> interferencePowers(grid.getNumSlots() * numResourceBlocks, 0);
+    for (auto interferingReception : *interference->getInterferingReceptions()) {
+        auto scalarReception = dynamic_cast<const ScalarReception *>(interferingReception);
+        if (scalarReception == nullptr)
+            throw cRuntimeError("Unsupported interfering reception");
+        double interferingPower = scalarReception->getPower().get();
+        double interferingStartTime = interferingReception->getStartTime().dbl();
+        double interferingEndTime = interferingReception->getEndTime().dbl();
+        auto interferingTransmission = dynamic_cast<const LteTransmission *>(interferingReception->getTransmission());
+        if (interferingTransmission == nullptr) {
+            double carrierFrequency = scalarReception->getCarrierFrequency().get();
+            double bandwidth = scalarReception->getBandwidth().get();
+            // signals with unknown band are considered to cover the whole frame
+            if (std::isnan(carrierFrequency) || std::isnan(bandwidth))
+                addInterference(interferencePowers, mode, startTime, minFrequency, interferingStartTime, interferingEndTime, minFrequency, maxFrequency, interferingPower);
+            else
+                addInterference(interferencePowers, mode, startTime, minFrequency, interferingStartTime, interferingEndTime, carrierFrequency - bandwidth / 2, carrierFrequency + bandwidth / 2, interferingPower);
+        }
+        else {
+            auto interferingFrame = check_and_cast<const Frame *>(interferingTransmission->getPacket());
+            const auto& interferingGrid = interferingFrame->getGrid();
+            const auto& interferingMode = interferingGrid.getMode();
+            double interferingSlotDuration = interferingMode.getSlotDuration().dbl();
+            double interferingResourceBlockBandwidth = interferingMode.getResourceBlockBandwidth().get();
+            double interferingMinFrequency = (interferingTransmission->getCarrierFrequency() - interferingMode.getBandwidth() / 2).get();
+            double interferingResourceBlockPower = interferingPower / interferingMode.getNumResourceBlocksPerSlot();
+            for (const auto& allocation : interferingGrid.getAllocations()) {
+                for (const auto& allocatedResourceBlock : allocation.resourceBlocks) {
+                    double resourceBlockStartTime = interferingStartTime - interferingFrame->getSignalOffset().dbl() + interferingGrid.getSlotIndex(allocatedResourceBlock.subframeIndex, allocatedResourceBlock.slotIndex) * interferingSlotDuration;
+                    double resourceBlockMinFrequency = interferingMinFrequency + allocatedResourceBlock.resourceBlockIndex * interferingResourceBlockBandwidth;
+                    addInterference(interferencePowers, mode, startTime, minFrequency, resourceBlockStartTime, resourceBlockStartTime + interferingSlotDuration, resourceBlockMinFrequency, resourceBlockMinFrequency + interferingResourceBlockBandwidth, interferingResourceBlockPower);
+                }
+            }
+        }
+    }
+    snirs.resize(interferencePowers.size());
+    for (size_t i = 0; i < snirs.size(); i++)
+        snirs[i] = signalPower / (noisePower + interferencePowers[i]);
+}
+
+void LteReceiver::addInterference(std::vector<double>& interferencePowers, const LteMode& mode, double startTime, double minFrequency, double interferenceStartTime, double interferenceEndTime, double interferenceMinFrequency, double interferenceMaxFrequency, double interferencePower) const
+{
+    int numSlots = mode.getNumSlotsPerFrame();
+    int numResourceBlocks = mode.getNumResourceBlocksPerSlot();
+    double slotDuration = mode.getSlotDuration().dbl();
+    double resourceBlockBandwidth = mode.getResourceBlockBandwidth().get();
+    double interferenceBandwidth = interferenceMaxFrequency - interferenceMinFrequency;
+    // only the resource blocks overlapping the interference both in time and frequency are visited
+    int firstSlotIndex = (int)std::max(0.0, std::floor((interferenceStartTime - startTime) / slotDuration));
+    int lastSlotIndex = (int)std::min(numSlots - 1.0, std::ceil((interferenceEndTime - startTime) / slotDuration) - 1);
+    int firstResourceBlockIndex = (int)std::max(0.0, std::floor((interferenceMinFrequency - minFrequency) / resourceBlockBandwidth));
+    int lastResourceBlockIndex = (int)std::min(numResourceBlocks - 1.0, std::ceil((interferenceMaxFrequency - minFrequency) / resourceBlockBandwidth) - 1);
+    for (int i = firstSlotIndex; i <= lastSlotIndex; i++) {
+        double slotStartTime = startTime + i * slotDuration;
+        double timeOverlap = std::min(slotStartTime + slotDuration, interferenceEndTime) - std::max(slotStartTime, interferenceStartTime);
+        if (timeOverlap <= 0)
+            continue;
+        double slotInterferencePower = interferencePower * timeOverlap / slotDuration / interferenceBandwidth;
+        double *resourceBlockInterferencePowers = interferencePowers.data() + i * numResourceBlocks;
+        for (int j = firstResourceBlockIndex; j <= lastResourceBlockIndex; j++) {
+            double resourceBlockMinFrequency = minFrequency + j * resourceBlockBandwidth;
+            double frequencyOverlap = std::min(resourceBlockMinFrequency + resourceBlockBandwidth, interferenceMaxFrequency) - std::max(resourceBlockMinFrequency, interferenceMinFrequency);
+            if (frequencyOverlap > 0)
+                resourceBlockInterferencePowers[j] += slotInterferencePower * frequencyOverlap;
+        }
+    }
+}
+
+ResourceGrid::ResourceGrid(const LteMode& mode, LevelOfDetail levelOfDetail) :
+    mode(mode),
+    levelOfDetail(levelOfDetail)
+{
+    numSlots = mode.getNumSlotsPerFrame();
+    resourceBlockStride = levelOfDetail > LevelOfDetail::RESOURCE_BLOCK ? mode.getNumResourceElementsPerResourceBlock() : 1;
+    slotStride = resourceBlockStride * mode.getNumResourceBlocksPerSlot();
+    cellLength = levelOfDetail > LevelOfDetail::RESOURCE_BLOCK ? mode.getResourceElementLength() : mode.getResourceBlockLength();
+    slotOffsets.resize(numSlots, -1);
+    slotContents.resize(numSlots);
+    subframeContents.resize(mode.getNumSubframesPerFrame());
+    switch (levelOfDetail) {
+        case LevelOfDetail::FRAME: unitStride = slotStride * numSlots; break;
+        case LevelOfDetail::SUBFRAME: unitStride = slotStride * mode.getNumSlotsPerSubframe(); break;
+        default: unitStride = slotStride; break;
+    }
+    if (isCoarse()) {
+        // there are no cells to allocate, so all slots are considered allocated from the beginning
+        for (int i = 0; i < numSlots; i++) {
+            slotOffsets[i] = i * slotStride;
+            blockSlots.push_back(i);
+        }
+    }
+}
+
+ResourceGrid& ResourceGrid::operator=(const ResourceGrid& other)
+{
+    if (this != &other) {
+        mode = other.mode;
+        levelOfDetail = other.levelOfDetail;
+        numSlots = other.numSlots;
+        resourceBlockStride = other.resourceBlockStride;
+        slotStride = other.slotStride;
+        unitStride = other.unitStride;
+        cellLength = other.cellLength;
+        slotOffsets = other.slotOffsets;
+        blockSlots = other.blockSlots;
+        cells = other.cells;
+        cellRuns = other.cellRuns;
+        runs = other.runs;
+        runStarts = other.runStarts;
+        allocations = other.allocations;
+        resourceBlockContents = other.resourceBlockContents;
+        slotContents = other.slotContents;
+        subframeContents = other.subframeContents;
+        // the views of the other grid refer to that grid
+        subframeViews.clear();
+        slotViews.clear();
+        resourceBlockViews.clear();
+        resourceElementViews.clear();
+    }
+    return *this;
+}
+
+int ResourceGrid::allocateSlot(int slotIndex)
+{
+    ASSERT(slotOffsets[slotIndex] == -1);
+    int offset = cells.size();
+    cells.resize(offset + slotStride);
+    cellRuns.resize(offset + slotStride, -1);
+    if (levelOfDetail > LevelOfDetail::RESOURCE_BLOCK)
+        resourceBlockContents.resize(resourceBlockContents.size() + mode.getNumResourceBlocksPerSlot());
+    slotOffsets[slotIndex] = offset;
+    blockSlots.push_back(slotIndex);
+    return offset;
+}
+
+void ResourceGrid::invalidateContents(int cell)
+{
+    int slotIndex = blockSlots[cell / slotStride];
+    if (levelOfDetail > LevelOfDetail::RESOURCE_BLOCK)
+        resourceBlockContents[cell / resourceBlockStride] = nullptr;
+    slotContents[slotIndex] = nullptr;
+    subframeContents[slotIndex / mode.getNumSlotsPerSubframe()] = nullptr;
+}
+
+void ResourceGrid::setRunContent(int startCell, const Ptr<const Chunk>& content)
+{
+    if (!isCoarse())
+        addRun(startCell, content);
+    else {
+        // the run is split at the boundaries of the frame, subframes, or slots
+        b length = content->getChunkLength();
+        b offset = b(0);
+        int cell = startCell;
+        while (offset < length) {
+            int unitEndCell = (cell / unitStride + 1) * unitStride;
+            b partLength = std::min(length - offset, cellLength * (unitEndCell - cell));
+            addRun(cell, offset == b(0) && partLength == length ? content : content->peek(offset, partLength));
+            offset += partLength;
+            cell = unitEndCell;
+        }
+    }
+}
+
+void ResourceGrid::addRun(int startCell, const Ptr<const Chunk>& content)
 {
-    // NOTE: generate fake allocation, this should be done somewhere else
-    for (int i = 0; i < 100; i++) {
-        AllocatedResourceBlock allocatedResourceBlock;
-        allocatedResourceBlock.subframeIndex = 0;
-        allocatedResourceBlock.slotIndex = 0;
-        allocatedResourceBlock.resourceBlockIndex = i;
-        allocatedResourceBlocks.push_back(allocatedResourceBlock);
+    int numCells = (content->getChunkLength().get() + cellLength.get() - 1) / cellLength.get();
+    int runIndex = runs.size();
+    if (isCoarse()) {
+        auto it = runStarts.lower_bound(startCell + numCells);
+        if (it != runStarts.begin()) {
+            const auto& previousRun = runs[std::prev(it)->second];
+            if (previousRun.startCell + previousRun.numCells > startCell)
+                throw cRuntimeError("Resource blocks are already occupied");
+        }
+        runStarts[startCell] = runIndex;
+        for (int slotIndex = startCell / slotStride; slotIndex <= (startCell + numCells - 1) / slotStride; slotIndex++)
+            invalidateContents(slotIndex * slotStride);
     }
+    else {
+        for (int cell = startCell; cell < startCell + numCells; cell++) {
+            cells[cell] = nullptr;
+            cellRuns[cell] = runIndex;
+        }
+        for (int cell = startCell; cell < startCell + numCells; cell += resourceBlockStride)
+            invalidateContents(cell);
+    }
+    ContentRun run;
+    run.content = content;
+    run.startCell = startCell;
+    run.numCells = numCells;
+    runs.push_back(run);
+}
+
+Ptr<const Chunk> ResourceGrid::getRunContent(int runIndex, int startCell, int endCell) const
+{
+    const auto& run = runs[runIndex];
+    b runLength = run.content->getChunkLength();
+    b offset = cellLength * (startCell - run.startCell);
+    b length = cellLength * (endCell - startCell);
+    if (offset + length > runLength)
+        length = runLength - offset;
+    if (length <= b(0))
+        return nullptr;
+    else if (offset == b(0) && length == runLength)
+        return run.content;
+    else
+        return run.content->peek(offset, length);
+}
+
+void ResourceGrid::appendContents(Ptr<SequenceChunk>& content, int startCell, int endCell) const
+{
+    if (isCoarse()) {
+        // visit the runs overlapping the cells, starting with the one that may begin before them
+        auto it = runStarts.upper_bound(startCell);
+        if (it != runStarts.begin())
+            it--;
+        for (; it != runStarts.end() && it->first < endCell; it++) {
+            const auto& run = runs[it->second];
+            int runStartCell = std::max(startCell, run.startCell);
+            int runEndCell = std::min(endCell, run.startCell + run.numCells);
+            auto runContent = runStartCell < runEndCell ? getRunContent(it->second, runStartCell, runEndCell) : nullptr;
+            if (runContent != nullptr) {
+                if (content == nullptr)
+                    content = makeShared<SequenceChunk>();
+                content->insertAtBack(runContent);
+            }
+        }
+        return;
+    }
+    for (int cell = startCell; cell < endCell;) {
+        Ptr<const Chunk> cellContent;
+        int runIndex = cellRuns[cell];
+        if (runIndex == -1)
+            cellContent = cells[cell++];
+        else {
+            // take as many cells from the run as possible with a single slice
+            int runEndCell = std::min(endCell, runs[runIndex].startCell + runs[runIndex].numCells);
+            int nextCell = cell + 1;
+            while (nextCell < runEndCell && cellRuns[nextCell] == runIndex)
+                nextCell++;
+            cellContent = getRunContent(runIndex, cell, nextCell);
+            cell = nextCell;
+        }
+        if (cellContent != nullptr) {
+            if (content == nullptr)
+                content = makeShared<SequenceChunk>();
+            content->insertAtBack(cellContent);
+        }
+    }
+}
+
+Ptr<const Chunk> ResourceGrid::computeContent(int startCell, int endCell) const
+{
+    Ptr<SequenceChunk> content = nullptr;
+    appendContents(content, startCell, endCell);
+    if (content != nullptr)
+        content->markImmutable();
+    return content;
+}
+
+Ptr<const Chunk> ResourceGrid::getResourceBlockContent(int slotIndex, int resourceBlockIndex) const
+{
+    int cell = findResourceBlockCell(slotIndex, resourceBlockIndex);
+    if (cell == -1)
+        return nullptr;
+    else if (levelOfDetail <= LevelOfDetail::RESOURCE_BLOCK)
+        return getCellContent(cell);
+    else {
+        auto& content = resourceBlockContents[cell / resourceBlockStride];
+        if (content == nullptr)
+            content = computeContent(cell, cell + resourceBlockStride);
+        return content;
+    }
+}
+
+Ptr<const Chunk> ResourceGrid::getSlotContent(int slotIndex) const
+{
+    int offset = slotOffsets[slotIndex];
+    if (offset == -1)
+        return nullptr;
+    auto& content = slotContents[slotIndex];
+    if (content == nullptr)
+        content = computeContent(offset, offset + slotStride);
+    return content;
+}
+
+Ptr<const Chunk> ResourceGrid::getSubframeContent(int subframeIndex) const
+{
+    auto& content = subframeContents[subframeIndex];
+    if (content == nullptr && isCoarse()) {
+        int numSubframeCells = slotStride * mode.getNumSlotsPerSubframe();
+        content = computeContent(subframeIndex * numSubframeCells, (subframeIndex + 1) * numSubframeCells);
+    }
+    else if (content == nullptr) {
+        Ptr<SequenceChunk> subframeContent = nullptr;
+        for (int i = 0; i < mode.getNumSlotsPerSubframe(); i++) {
+            auto slotContent = getSlotContent(getSlotIndex(subframeIndex, i));
+            if (slotContent != nullptr) {
+                if (subframeContent == nullptr)
+                    subframeContent = makeShared<SequenceChunk>();
+                subframeContent->insertAtBack(slotContent);
+            }
+        }
+        if (subframeContent != nullptr)
+            subframeContent->markImmutable();
+        content = subframeContent;
+    }
+    return content;
+}
+
+Ptr<const Chunk> ResourceGrid::getFrameContent() const
+{
+    Ptr<SequenceChunk> content = nullptr;
+    if (isCoarse())
+        appendContents(content, 0, numSlots * slotStride);
+    else {
+        for (int slotIndex = 0; slotIndex < numSlots; slotIndex++) {
+            int offset = slotOffsets[slotIndex];
+            if (offset != -1)
+                appendContents(content, offset, offset + slotStride);
+        }
+    }
+    if (content != nullptr)
+        content->markImmutable();
+    return content;
+}
+
+bool ResourceGrid::isSubframeAllocated(int subframeIndex) const
+{
+    for (int i = 0; i < mode.getNumSlotsPerSubframe(); i++)
+        if (isSlotAllocated(getSlotIndex(subframeIndex, i)))
+            return true;
+    return false;
+}
+
+Subframe *ResourceGrid::getSubframeView(int subframeIndex) const
+{
+    if (!isSubframeAllocated(subframeIndex))
+        return nullptr;
+    auto it = subframeViews.find(subframeIndex);
+    if (it == subframeViews.end())
+        it = subframeViews.emplace(subframeIndex, Subframe(this, nullptr, subframeIndex)).first;
+    return &it->second;
+}
+
+Slot *ResourceGrid::getSlotView(int slotIndex) const
+{
+    if (!isSlotAllocated(slotIndex))
+        return nullptr;
+    auto it = slotViews.find(slotIndex);
+    if (it == slotViews.end())
+        it = slotViews.emplace(slotIndex, Slot(this, nullptr, slotIndex)).first;
+    return &it->second;
+}
+
+ResourceBlock *ResourceGrid::getResourceBlockView(int slotIndex, int resourceBlockIndex) const
+{
+    int cell = findResourceBlockCell(slotIndex, resourceBlockIndex);
+    if (cell == -1)
+        return nullptr;
+    auto it = resourceBlockViews.find(cell);
+    if (it == resourceBlockViews.end())
+        it = resourceBlockViews.emplace(cell, ResourceBlock(this, nullptr, slotIndex, resourceBlockIndex)).first;
+    return &it->second;
+}
+
+ResourceElement *ResourceGrid::getResourceElementView(int slotIndex, int resourceBlockIndex, int resourceElementIndex) const
+{
+    int cell = findResourceElementCell(slotIndex, resourceBlockIndex, resourceElementIndex);
+    if (cell == -1)
+        return nullptr;
+    auto it = resourceElementViews.find(cell);
+    if (it == resourceElementViews.end())
+        it = resourceElementViews.emplace(cell, ResourceElement(this, nullptr, slotIndex, resourceBlockIndex, resourceElementIndex)).first;
+    return &it->second;
+}
+
+LteRadio::~LteRadio()
+{
+    cancelAndDelete(frameTimer);
+    cancelAndDelete(replayTimer);
+    delete frameTraceWriter;
+    delete frameTraceReader;
+    for (auto& it : pendingFrames)
+        delete it.second;
+    for (auto& it : txQueues)
+        for (auto& queuedPacket : it.second)
+            delete queuedPacket.packet;
+}
+
+void LteRadio::initialize(int stage)
+{
+    Radio::initialize(stage);
+    if (stage == INITSTAGE_LOCAL) {
+        const char *levelOfDetailString = par("levelOfDetail");
+        if (!strcmp(levelOfDetailString, "FRAME"))
+            levelOfDetail = LevelOfDetail::FRAME;
+        else if (!strcmp(levelOfDetailString, "SUBFRAME"))
+            levelOfDetail = LevelOfDetail::SUBFRAME;
+        else if (!strcmp(levelOfDetailString, "SLOT"))
+            levelOfDetail = LevelOfDetail::SLOT;
+        else if (!strcmp(levelOfDetailString, "RESOURCE_BLOCK"))
+            levelOfDetail = LevelOfDetail::RESOURCE_BLOCK;
+        else if (!strcmp(levelOfDetailString, "RESOURCE_ELEMENT"))
+            levelOfDetail = LevelOfDetail::RESOURCE_ELEMENT;
+        else
+            throw cRuntimeError("Unknown level of detail: %s", levelOfDetailString);
+        LteBandwidth bandwidth;
+        double channelBandwidth = par("channelBandwidth");
+        if (channelBandwidth == 1.4E+6)
+            bandwidth = LteBandwidth::MHZ_1_4;
+        else if (channelBandwidth == 3E+6)
+            bandwidth = LteBandwidth::MHZ_3;
+        else if (channelBandwidth == 5E+6)
+            bandwidth = LteBandwidth::MHZ_5;
+        else if (channelBandwidth == 10E+6)
+            bandwidth = LteBandwidth::MHZ_10;
+        else if (channelBandwidth == 15E+6)
+            bandwidth = LteBandwidth::MHZ_15;
+        else if (channelBandwidth == 20E+6)
+            bandwidth = LteBandwidth::MHZ_20;
+        else
+            throw cRuntimeError("Unknown channel bandwidth: %g Hz", channelBandwidth);
+        LteCyclicPrefix cyclicPrefix;
+        const char *cyclicPrefixString = par("cyclicPrefix");
+        if (!strcmp(cyclicPrefixString, "normal"))
+            cyclicPrefix = LteCyclicPrefix::NORMAL;
+        else if (!strcmp(cyclicPrefixString, "extended"))
+            cyclicPrefix = LteCyclicPrefix::EXTENDED;
+        else
+            throw cRuntimeError("Unknown cyclic prefix: %s", cyclicPrefixString);
+        LteModulation modulation;
+        const char *modulationString = par("modulation");
+        if (!strcmp(modulationString, "QPSK"))
+            modulation = LteModulation::QPSK;
+        else if (!strcmp(modulationString, "QAM-16"))
+            modulation = LteModulation::QAM16;
+        else if (!strcmp(modulationString, "QAM-64"))
+            modulation = LteModulation::QAM64;
+        else
+            throw cRuntimeError("Unknown modulation: %s", modulationString);
+        int codeRate = par("codeRate");
+        if (codeRate < 0 || codeRate >= 1024)
+            throw cRuntimeError("Invalid code rate: %d", codeRate);
+        mode = LteMode(bandwidth, cyclicPrefix, modulation, codeRate);
+        if (mode.getResourceBlockLength() == b(0))
+            throw cRuntimeError("Code rate %d leaves no payload in a resource block", codeRate);
+        splitSignals = par("splitSignals");
+        timerSamplingInterval = par("timerSamplingInterval");
+        scheduler = check_and_cast<ILteScheduler *>(getSubmodule("scheduler"));
+        // the signal of a slot is only addressed to a single receiver if the slot carries a single destination
+        scheduler->setSingleDemandPerSubframe(splitSignals);
+        frameTimer = new cMessage("FrameTimer");
+        const char *frameTraceFile = par("frameTraceFile");
+        if (*frameTraceFile != '\0')
+            frameTraceWriter = new FrameTraceWriter(frameTraceFile);
+        const char *replayFrameTraceFile = par("replayFrameTraceFile");
+        if (*replayFrameTraceFile != '\0') {
+            frameTraceReader = new FrameTraceReader(replayFrameTraceFile);
+            replaySnir = math::dB2fraction(par("replaySnir"));
+            replayTimer = new cMessage("ReplayTimer");
+            if (frameTraceReader->hasNextFrame())
+                scheduleAt(std::max(simTime(), frameTraceReader->getNextFrameStartTime()), replayTimer);
+        }
+    }
+}
+
+void LteRadio::handleSelfMessage(cMessage *message)
+{
+    if (message == frameTimer) {
+        // the radio doesn't leave transmitter mode while there are pending transmissions, see setRadioMode
+        ASSERT(isTransmitterMode(radioMode));
+        if (!pendingFrames.empty())
+            transmitPendingFrame();
+        else
+            transmitFrame();
+    }
+    else if (message == replayTimer)
+        replayFrame();
+    else
+        Radio::handleSelfMessage(message);
 }
 
 void LteRadio::handleUpperPacket(Packet *packet)
 {
-    auto frame = new Frame(mode, levelOfDetail);
+    // packets are only queued in transmitter mode, the base class drops them otherwise
+    if (!isTransmitterMode(radioMode))
+        Radio::handleUpperPacket(packet);
+    else {
+        auto macAddressReq = packet->findTag<MacAddressReq>();
+        auto destination = macAddressReq != nullptr ? macAddressReq->getDestAddress() : MacAddress::BROADCAST_ADDRESS;
+        QueuedPacket queuedPacket;
+        queuedPacket.packet = packet;
+        txQueues[destination].push_back(queuedPacket);
+        // packets arriving within the same TTI are sent in the same frame
+        if (!frameTimer->isScheduled() && !transmissionTimer->isScheduled() && pendingFrames.empty())
+            scheduleAt(getNextSubframeTime(), frameTimer);
+    }
+}
+
+void LteRadio::endTransmission()
+{
+    Radio::endTransmission();
+    if (!frameTimer->isScheduled()) {
+        if (!pendingFrames.empty())
+            scheduleAt(pendingFrames.begin()->first, frameTimer);
+        else if (!txQueues.empty())
+            scheduleAt(getNextSubframeTime(), frameTimer);
+    }
+    if (isRadioModeDeferred && !hasPendingTransmissions())
+        setRadioMode(deferredRadioMode);
+}
+
+void LteRadio::setRadioMode(RadioMode newRadioMode)
+{
+    if (isTransmitterMode(radioMode) && !isTransmitterMode(newRadioMode) && hasPendingTransmissions()) {
+        isRadioModeDeferred = true;
+        deferredRadioMode = newRadioMode;
+    }
+    else {
+        isRadioModeDeferred = false;
+        Radio::setRadioMode(newRadioMode);
+    }
+}
+
+Frame *LteRadio::createFrame(const LteMode& mode, LevelOfDetail levelOfDetail, int slotIndex)
+{
+    auto frame = new Frame(mode, levelOfDetail, slotIndex);
     frame->setName("LteFrame");
     frame->addTag<PacketProtocolTag>()->setProtocol(&lte);
-    insertPacketIntoFrame(*packet, b(0), packet->getTotalLength(), *frame, allocatedResourceBlocks);
-    delete packet;
-    computeFrameContent(*frame);
-    Radio::handleUpperPacket(frame);
+    return frame;
+}
+
+void LteRadio::transmitFrame()
+{
+    WallclockTimer timer(this, transmitFrameTimeSignal, isTimerSampled(numTimedTransmitFrameCalls));
+    std::vector<LteDemand> demands;
+    for (const auto& it : txQueues) {
+        LteDemand demand;
+        demand.destination = it.first;
+        for (const auto& queuedPacket : it.second)
+            demand.length += queuedPacket.packet->getTotalLength() - queuedPacket.offset;
+        // zero length packets still need a resource block to carry their segments
+        if (demand.length == b(0))
+            demand.length = b(1);
+        demands.push_back(demand);
+    }
+    scheduler->scheduleFrame(mode, demands);
+    size_t numAllocatedResourceBlocks = 0;
+    for (const auto& demand : demands)
+        numAllocatedResourceBlocks += demand.allocatedResourceBlocks.size();
+    emit(resourceBlockUtilizationSignal, (double)numAllocatedResourceBlocks / (mode.getNumSlotsPerFrame() * mode.getNumResourceBlocksPerSlot()));
+    auto frame = splitSignals ? nullptr : createFrame(mode, levelOfDetail, -1);
+    std::vector<Frame *> frames(splitSignals ? mode.getNumSlotsPerFrame() : 0);
+    auto source = getAddress();
+    for (const auto& demand : demands) {
+        if (demand.allocatedResourceBlocks.empty())
+            continue;
+        auto& txQueue = txQueues[demand.destination];
+        ResourceAllocation allocation;
+        allocation.source = source;
+        allocation.destination = demand.destination;
+        allocation.resourceBlocks = demand.allocatedResourceBlocks;
+        // the queued packets are packed one after the other into the allocated resource blocks
+        Packet aggregate;
+        auto freeLength = mode.getResourceBlockLength() * demand.allocatedResourceBlocks.size();
+        while (freeLength > b(0) && !txQueue.empty()) {
+            auto& queuedPacket = txQueue.front();
+            PacketSegment segment;
+            segment.offset = queuedPacket.offset;
+            segment.packetLength = queuedPacket.packet->getTotalLength();
+            segment.length = std::min(segment.packetLength - segment.offset, freeLength);
+            if (segment.length > b(0))
+                aggregate.insertAtBack(queuedPacket.packet->peekAt(segment.offset, segment.length));
+            allocation.segments.push_back(segment);
+            queuedPacket.offset += segment.length;
+            freeLength -= segment.length;
+            if (queuedPacket.offset == segment.packetLength) {
+                delete queuedPacket.packet;
+                txQueue.pop_front();
+            }
+        }
+        if (splitSignals)
+            insertAllocationIntoSlotFrames(aggregate, allocation, frames);
+        else {
+            insertPacketIntoFrame(aggregate, b(0), aggregate.getTotalLength(), *frame, allocation.resourceBlocks);
+            frame->getGridForUpdate().addAllocation(allocation);
+        }
+        if (txQueue.empty())
+            txQueues.erase(demand.destination);
+    }
+    if (!splitSignals)
+        frames.push_back(frame);
+    // the frames are transmitted at the beginning of their slots
+    simtime_t frameStartTime = simTime();
+    for (auto frame : frames) {
+        if (frame == nullptr)
+            continue;
+        else if (frame->getGrid().getAllocations().empty())
+            delete frame;
+        else {
+            computeFrameContent(*frame);
+            emit(frameLengthSignal, (double)frame->getTotalLength().get());
+            // receivers are only addressed individually if the frame carries resource blocks for one destination only,
+            // which is always the case for split signals, so the radio medium can skip the other receivers if its MAC
+            // address filter is enabled
+            const auto& allocations = frame->getGrid().getAllocations();
+            auto destination = allocations[0].destination;
+            for (const auto& allocation : allocations)
+                if (allocation.destination != destination)
+                    destination = MacAddress::BROADCAST_ADDRESS;
+            frame->addTag<MacAddressReq>()->setDestAddress(destination);
+            if (frameTraceWriter != nullptr)
+                frameTraceWriter->writeFrame(frameStartTime + frame->getSignalOffset(), *frame);
+            pendingFrames[frameStartTime + frame->getSignalOffset()] = frame;
+        }
+    }
+    if (pendingFrames.empty())
+        throw cRuntimeError("Scheduler didn't allocate any resource blocks");
+    transmitPendingFrame();
+}
+
+void LteRadio::transmitPendingFrame()
+{
+    auto it = pendingFrames.begin();
+    if (it->first > simTime())
+        scheduleAt(it->first, frameTimer);
+    else {
+        auto frame = it->second;
+        pendingFrames.erase(it);
+        Radio::handleUpperPacket(frame);
+    }
+}
+
+void LteRadio::insertAllocationIntoSlotFrames(const Packet& aggregate, const ResourceAllocation& allocation, std::vector<Frame *>& frames)
+{
+    const auto& resourceBlocks = allocation.resourceBlocks;
+    auto resourceBlockLength = mode.getResourceBlockLength();
+    auto aggregateLength = aggregate.getTotalLength();
+    size_t i = 0;
+    // an empty aggregate, which only has zero length segments, still goes into the first slot
+    while (i < resourceBlocks.size() && (resourceBlockLength * i < aggregateLength || i == 0)) {
+        // consecutive allocated resource blocks in the same slot go into the same frame
+        int slotIndex = mode.getSlotIndex(resourceBlocks[i].subframeIndex, resourceBlocks[i].slotIndex);
+        size_t j = i + 1;
+        while (j < resourceBlocks.size() && mode.getSlotIndex(resourceBlocks[j].subframeIndex, resourceBlocks[j].slotIndex) == slotIndex)
+            j++;
+        auto startOffset = resourceBlockLength * i;
+        auto endOffset = std::min(resourceBlockLength * j, aggregateLength);
+        ResourceAllocation slotAllocation;
+        slotAllocation.source = allocation.source;
+        slotAllocation.destination = allocation.destination;
+        slotAllocation.resourceBlocks.assign(resourceBlocks.begin() + i, resourceBlocks.begin() + j);
+        // the segments are cut at the boundaries of the content carried in the slot
+        b segmentStartOffset = b(0);
+        for (const auto& segment : allocation.segments) {
+            auto segmentEndOffset = segmentStartOffset + segment.length;
+            auto overlapStartOffset = std::max(segmentStartOffset, startOffset);
+            auto overlapEndOffset = std::min(segmentEndOffset, endOffset);
+            // zero length segments go into the slot where they start, or into the last one at the end of the aggregate
+            bool isEmptySegmentInSlot = segment.length == b(0) && startOffset <= segmentStartOffset && (segmentStartOffset < endOffset || endOffset == aggregateLength);
+            if (overlapStartOffset < overlapEndOffset || isEmptySegmentInSlot) {
+                PacketSegment slotSegment;
+                slotSegment.offset = segment.offset + (overlapStartOffset - segmentStartOffset);
+                slotSegment.length = overlapEndOffset - overlapStartOffset;
+                slotSegment.packetLength = segment.packetLength;
+                slotAllocation.segments.push_back(slotSegment);
+            }
+            segmentStartOffset = segmentEndOffset;
+        }
+        auto& frame = frames[slotIndex];
+        if (frame == nullptr)
+            frame = createFrame(mode, levelOfDetail, slotIndex);
+        insertPacketIntoFrame(aggregate, startOffset, endOffset - startOffset, *frame, slotAllocation.resourceBlocks);
+        frame->getGridForUpdate().addAllocation(slotAllocation);
+        i = j;
+    }
 }
 
 void LteRadio::sendUp(Packet *packet)
 {
+    WallclockTimer timer(this, sendUpTimeSignal, isTimerSampled(numTimedSendUpCalls));
     auto frame = check_and_cast<Frame *>(packet);
-    packet = extractPacketFromFrame(*frame, allocatedResourceBlocks);
-    Radio::sendUp(packet);
+    // replayed frames are received regardless of their destinations
+    auto address = isReplayingFrame ? MacAddress::UNSPECIFIED_ADDRESS : getAddress();
+    for (const auto& allocation : frame->getGrid().getAllocations()) {
+        if (address.isUnspecified() || allocation.destination == address || allocation.destination.isMulticast()) {
+            std::vector<Ptr<const Chunk>> chunks;
+            extractContentFromFrame(*frame, allocation.resourceBlocks, chunks);
+            receiveSegments(allocation, chunks);
+        }
+    }
     delete frame;
 }
 
-void LteRadio::insertPacketIntoFrame(const Packet& packet, b offset, b length, Frame& frame, const std::vector<AllocatedResourceBlock>& allocatedResourceBlocks)
+void LteRadio::receiveSegments(const ResourceAllocation& allocation, const std::vector<Ptr<const Chunk>>& chunks)
 {
-    for (auto allocatedResourceBlock : allocatedResourceBlocks) {
-        auto& subframe = frame.getSubframe(allocatedResourceBlock.subframeIndex);
-        auto& slot = subframe.getSlot(allocatedResourceBlock.slotIndex);
-        auto& resourceBlock = slot.getResourceBlock(allocatedResourceBlock.resourceBlockIndex);
-        switch (levelOfDetail) {
-            case LevelOfDetail::RESOURCE_BLOCK: {
-                auto peekLength = mode.getResourceBlockLength();
-                if (peekLength > length)
-                    peekLength = length;
-                auto content = packet.peekAt(offset, peekLength);
-                resourceBlock.setContent(content);
-                offset += peekLength;
-                length -= peekLength;
-                if (length == b(0))
-                    return;
-                break;
-            }
-            case LevelOfDetail::RESOURCE_ELEMENT: {
-                for (int i = 0; i < mode.getNumResourceElementsPerResourceBlock(); i++) {
-                    auto& resourceElement = resourceBlock.getResourceElement(i);
-                    auto peekLength = mode.getResourceElementLength();
-                    if (peekLength > length)
-                        peekLength = length;
-                    auto content = packet.peekAt(offset, peekLength);
-                    resourceElement.setContent(content);
-                    offset += peekLength;
-                    length -= peekLength;
-                    if (length == b(0))
-                        return;
+    size_t chunkIndex = 0;
+    b chunkOffset = b(0);
+    for (const auto& segment : allocation.segments) {
+        auto key = std::make_pair(allocation.source, allocation.destination);
+        if (segment.offset == b(0))
+            partialPackets.erase(key);
+        auto it = partialPackets.find(key);
+        // a segment is dropped if the preceding part of the packet is missing
+        bool isContinuous = segment.offset == b(0) || (it != partialPackets.end() && it->second.length == segment.offset);
+        auto& partialPacket = partialPackets[key];
+        b remainingLength = segment.length;
+        while (remainingLength > b(0) && chunkIndex < chunks.size()) {
+            const auto& chunk = chunks[chunkIndex];
+            auto chunkLength = chunk->getChunkLength();
+            auto partLength = std::min(chunkLength - chunkOffset, remainingLength);
+            if (isContinuous) {
+                if (chunkOffset == b(0) && partLength == chunkLength)
+                    appendContent(partialPacket.chunks, chunk);
+                else {
+                    auto part = chunk->peek(chunkOffset, partLength, Chunk::PF_ALLOW_INCORRECT);
+                    appendContent(partialPacket.chunks, chunk->isCorrect() || !part->isCorrect() ? part : createIncorrectChunk(part));
                 }
-                break;
             }
-            default:
-                throw cRuntimeError("Unknown level of detail");
+            chunkOffset += partLength;
+            remainingLength -= partLength;
+            if (chunkOffset == chunkLength) {
+                chunkIndex++;
+                chunkOffset = b(0);
+            }
+        }
+        if (!isContinuous || remainingLength != b(0))
+            partialPackets.erase(key);
+        else {
+            partialPacket.length += segment.length;
+            partialPacket.numSegments++;
+            if (partialPacket.length == segment.packetLength) {
+                emit(packetSegmentsSignal, (long)partialPacket.numSegments);
+                // counted before the packet is built, because peeking would reject its incorrect chunks
+                emit(packetChunksSignal, (long)partialPacket.chunks.size());
+                auto receivedPacket = createPacket(partialPacket.chunks);
+                if (isReplayingFrame)
+                    delete receivedPacket;
+                else
+                    Radio::sendUp(receivedPacket);
+                partialPackets.erase(key);
+            }
         }
     }
-    throw cRuntimeError("Insufficient space");
 }
 
-Packet *LteRadio::extractPacketFromFrame(Frame& frame, const std::vector<AllocatedResourceBlock>& allocatedResourceBlocks)
+MacAddress LteRadio::getAddress() const
 {
-    auto packet = new Packet("LtePacket");
-    for (auto allocatedResourceBlock : allocatedResourceBlocks) {
-        auto& subframe = frame.getSubframe(allocatedResourceBlock.subframeIndex);
-        auto& slot = subframe.getSlot(allocatedResourceBlock.slotIndex);
-        auto& resourceBlock = slot.getResourceBlock(allocatedResourceBlock.resourceBlockIndex);
-        switch (levelOfDetail) {
-            case LevelOfDetail::RESOURCE_BLOCK: {
-                const auto& content = resourceBlock.getContent();
-                if (content != nullptr)
-                    packet->insertAtBack(content);
+    auto interfaceEntry = findContainingNicModule(this);
+    return interfaceEntry != nullptr ? interfaceEntry->getMacAddress() : MacAddress::UNSPECIFIED_ADDRESS;
+}
+
+void LteRadio::insertPacketIntoFrame(const Packet& packet, b offset, b length, Frame& frame, const std::vector<AllocatedResourceBlock>& allocatedResourceBlocks)
+{
+    auto& grid = frame.getGridForUpdate();
+    int resourceBlockStride = grid.getResourceBlockStride();
+    auto resourceBlockLength = grid.getMode().getResourceBlockLength();
+    // at RESOURCE_ELEMENT level the payload doesn't fill the cells of a resource block, so runs can't span several of them
+    bool isResourceBlockFilled = grid.getCellLength() * resourceBlockStride == resourceBlockLength;
+    size_t i = 0;
+    while (length > b(0)) {
+        if (i == allocatedResourceBlocks.size())
+            throw cRuntimeError("Insufficient space");
+        // allocated resource blocks with consecutive cells form a run, which is sliced from the packet at once
+        const auto& allocatedResourceBlock = allocatedResourceBlocks[i++];
+        int runStartCell = grid.getResourceBlockCell(grid.getSlotIndex(allocatedResourceBlock.subframeIndex, allocatedResourceBlock.slotIndex), allocatedResourceBlock.resourceBlockIndex);
+        int runEndCell = runStartCell + resourceBlockStride;
+        while (isResourceBlockFilled && grid.getCellLength() * (runEndCell - runStartCell) < length && i < allocatedResourceBlocks.size()) {
+            const auto& nextResourceBlock = allocatedResourceBlocks[i];
+            if (grid.findResourceBlockCell(grid.getSlotIndex(nextResourceBlock.subframeIndex, nextResourceBlock.slotIndex), nextResourceBlock.resourceBlockIndex) != runEndCell)
                 break;
-            }
-            case LevelOfDetail::RESOURCE_ELEMENT: {
-                for (int i = 0; i < mode.getNumResourceElementsPerResourceBlock(); i++) {
-                    auto& resourceElement = resourceBlock.getResourceElement(i);
-                    const auto& content = resourceElement.getContent();
-                    if (content != nullptr)
-                        packet->insertAtBack(content);
-                }
+            runEndCell += resourceBlockStride;
+            i++;
+        }
+        auto runLength = resourceBlockLength * ((runEndCell - runStartCell) / resourceBlockStride);
+        if (runLength > length)
+            runLength = length;
+        grid.setRunContent(runStartCell, packet.peekAt(offset, runLength));
+        offset += runLength;
+        length -= runLength;
+    }
+}
+
+Packet *LteRadio::extractPacketFromFrame(const Frame& frame, const std::vector<AllocatedResourceBlock>& allocatedResourceBlocks)
+{
+    std::vector<Ptr<const Chunk>> chunks;
+    extractContentFromFrame(frame, allocatedResourceBlocks, chunks);
+    return createPacket(chunks);
+}
+
+void LteRadio::extractContentFromFrame(const Frame& frame, const std::vector<AllocatedResourceBlock>& allocatedResourceBlocks, std::vector<Ptr<const Chunk>>& chunks)
+{
+    const auto& grid = frame.getGrid();
+    int resourceBlockStride = grid.getResourceBlockStride();
+    size_t i = 0;
+    while (i < allocatedResourceBlocks.size()) {
+        // allocated resource blocks with consecutive cells and the same correctness are read at once
+        const auto& allocatedResourceBlock = allocatedResourceBlocks[i++];
+        int slotIndex = grid.getSlotIndex(allocatedResourceBlock.subframeIndex, allocatedResourceBlock.slotIndex);
+        int startCell = grid.findResourceBlockCell(slotIndex, allocatedResourceBlock.resourceBlockIndex);
+        if (startCell == -1)
+            continue;
+        bool isErroneous = frame.isResourceBlockErroneous(slotIndex, allocatedResourceBlock.resourceBlockIndex);
+        int endCell = startCell + resourceBlockStride;
+        while (i < allocatedResourceBlocks.size()) {
+            const auto& nextResourceBlock = allocatedResourceBlocks[i];
+            int nextSlotIndex = grid.getSlotIndex(nextResourceBlock.subframeIndex, nextResourceBlock.slotIndex);
+            if (grid.findResourceBlockCell(nextSlotIndex, nextResourceBlock.resourceBlockIndex) != endCell || frame.isResourceBlockErroneous(nextSlotIndex, nextResourceBlock.resourceBlockIndex) != isErroneous)
                 break;
+            endCell += resourceBlockStride;
+            i++;
+        }
+        auto content = grid.getContent(startCell, endCell);
+        if (content == nullptr)
+            continue;
+        else if (!isErroneous)
+            appendContent(chunks, content);
+        else {
+            std::vector<Ptr<const Chunk>> correctChunks;
+            appendContent(correctChunks, content);
+            for (const auto& chunk : correctChunks)
+                chunks.push_back(createIncorrectChunk(chunk));
+        }
+    }
+}
+
+Ptr<const Chunk> LteRadio::createIncorrectChunk(const Ptr<const Chunk>& chunk)
+{
+    auto incorrectChunk = chunk->dupShared();
+    incorrectChunk->markIncorrect();
+    incorrectChunk->markImmutable();
+    return incorrectChunk;
+}
+
+Packet *LteRadio::createPacket(const std::vector<Ptr<const Chunk>>& chunks)
+{
+    auto packet = new Packet("LtePacket");
+    for (const auto& chunk : chunks) {
+        if (!chunk->isCorrect())
+            packet->setBitError(true);
+        if (chunk->getChunkType() == Chunk::CT_SLICE) {
+            auto sliceChunk = staticPtrCast<const SliceChunk>(chunk);
+            const auto& originalChunk = sliceChunk->getChunk();
+            if (sliceChunk->isCorrect() && sliceChunk->getOffset() == b(0) && sliceChunk->getLength() == originalChunk->getChunkLength()) {
+                packet->insertAtBack(originalChunk);
+                continue;
             }
-            default:
-                throw cRuntimeError("Unknown level of detail");
         }
+        packet->insertAtBack(chunk);
     }
     return packet;
 }
 
+void LteRadio::appendContent(std::vector<Ptr<const Chunk>>& chunks, const Ptr<const Chunk>& content)
+{
+    if (content->getChunkType() == Chunk::CT_SEQUENCE) {
+        for (const auto& chunk : staticPtrCast<const SequenceChunk>(content)->getChunks())
+            appendContent(chunks, chunk);
+    }
+    else {
+        if (content->getChunkType() == Chunk::CT_SLICE && !chunks.empty() && chunks.back()->getChunkType() == Chunk::CT_SLICE) {
+            auto sliceChunk = staticPtrCast<const SliceChunk>(content);
+            auto previousSliceChunk = staticPtrCast<const SliceChunk>(chunks.back());
+            const auto& originalChunk = sliceChunk->getChunk();
+            if (originalChunk == previousSliceChunk->getChunk() && previousSliceChunk->getOffset() + previousSliceChunk->getLength() == sliceChunk->getOffset() &&
+                sliceChunk->isCorrect() && previousSliceChunk->isCorrect())
+            {
+                chunks.back() = originalChunk->peek(previousSliceChunk->getOffset(), previousSliceChunk->getLength() + sliceChunk->getLength());
+                return;
+            }
+        }
+        chunks.push_back(content);
+    }
+}
+
 void LteRadio::computeFrameContent(Frame& frame)
 {
-    auto frameContent = makeShared<SequenceChunk>();
-    for (int i = 0; i < mode.getNumSubframesPerFrame(); i++) {
-        auto& subframe = frame.getSubframe(i);
-        auto subframeContent = makeShared<SequenceChunk>();
-        for (int j = 0; j < mode.getNumSlotsPerSubframe(); j++) {
-            auto& slot = subframe.getSlot(j);
-            auto slotContent = makeShared<SequenceChunk>();
-            for (int k = 0; k < mode.getNumResourceBlocksPerSlot(); k++) {
-                auto& resourceBlock = slot.getResourceBlock(k);
-                if (levelOfDetail > LevelOfDetail::RESOURCE_BLOCK) {
-                    auto resourceBlockContent = makeShared<SequenceChunk>();
-                    for (int l = 0; l < mode.getNumResourceElementsPerResourceBlock(); l++) {
-                        auto& resourceElement = resourceBlock.getResourceElement(l);
-                        const auto& content = resourceElement.getContent();
-                        if (content != nullptr)
-                            resourceBlockContent->insertAtBack(content);
+    auto content = frame.getGrid().getFrameContent();
+    if (content != nullptr)
+        frame.setContent(content);
+    else
+        frame.removeAll();
+}
+
+void LteRadio::replayFrame()
+{
+    FrameTraceRecord record;
+    frameTraceReader->readFrame(record);
+    auto frame = createFrame(record.mode, record.levelOfDetail, record.slotIndex);
+    for (const auto& allocation : record.allocations) {
+        Packet aggregate;
+        for (const auto& segment : allocation.segments)
+            if (segment.length > b(0))
+                aggregate.insertAtBack(makeShared<BitCountChunk>(segment.length));
+        insertPacketIntoFrame(aggregate, b(0), aggregate.getTotalLength(), *frame, allocation.resourceBlocks);
+        frame->getGridForUpdate().addAllocation(allocation);
+    }
+    computeFrameContent(*frame);
+    if (frame->getTotalLength() != record.frameLength)
+        throw cRuntimeError("Replayed frame length %ld b differs from the recorded one %ld b", (long)frame->getTotalLength().get(), (long)record.frameLength.get());
+    // there's no radio medium involved, so every resource block is received with the same SNIR
+    const auto& mode = record.mode;
+    std::vector<double> snirs(mode.getNumSlotsPerFrame() * mode.getNumResourceBlocksPerSlot(), replaySnir);
+    std::vector<bool> erroneousResourceBlocks;
+    check_and_cast<const LteReceiver *>(getReceiver())->computeErroneousResourceBlocks(frame, numReplayedFrames++, snirs, erroneousResourceBlocks);
+    if (std::find(erroneousResourceBlocks.begin(), erroneousResourceBlocks.end(), true) != erroneousResourceBlocks.end())
+        frame->setErroneousResourceBlocks(erroneousResourceBlocks);
+    isReplayingFrame = true;
+    sendUp(frame);
+    isReplayingFrame = false;
+    if (frameTraceReader->hasNextFrame())
+        scheduleAt(std::max(simTime(), frameTraceReader->getNextFrameStartTime()), replayTimer);
+}
+
+// 3GPP TS 36.213 Table 7.2.3-1 with the SNIR of 10% block error rate in AWGN channel
+static const LteCqi cqiTable[] = {
+    { LteModulation::QPSK, 78, -6.7 },
+    { LteModulation::QPSK, 120, -4.7 },
+    { LteModulation::QPSK, 193, -2.3 },
+    { LteModulation::QPSK, 308, 0.2 },
+    { LteModulation::QPSK, 449, 2.4 },
+    { LteModulation::QPSK, 602, 4.3 },
+    { LteModulation::QAM16, 378, 5.9 },
+    { LteModulation::QAM16, 490, 8.1 },
+    { LteModulation::QAM16, 616, 10.3 },
+    { LteModulation::QAM64, 466, 11.7 },
+    { LteModulation::QAM64, 567, 14.1 },
+    { LteModulation::QAM64, 666, 16.3 },
+    { LteModulation::QAM64, 772, 18.7 },
+    { LteModulation::QAM64, 873, 21.0 },
+    { LteModulation::QAM64, 948, 22.7 }
+};
+
+static const double minSnirOffset = -8; // in dB relative to the reference SNIR
+static const double maxSnirOffset = 8; // in dB relative to the reference SNIR
+static const double snirOffsetStep = 0.01; // in dB
+static const double blockErrorRateDeviation = 1; // in dB, the block error rate drops from 10% to 1% over about this much
+
+void LteErrorModel::initialize(int stage)
+{
+    ErrorModelBase::initialize(stage);
+    if (stage == INITSTAGE_LOCAL)
+        getBlockErrorRateTable(); // built here so the worker threads only read it
+}
+
+const std::vector<double>& LteErrorModel::getBlockErrorRateTable()
+{
+    static const std::vector<double> table = [] () {
+        // the Gaussian tail which is 10% at the reference SNIR
+        std::vector<double> table((int)std::round((maxSnirOffset - minSnirOffset) / snirOffsetStep) + 1);
+        for (size_t i = 0; i < table.size(); i++)
+            table[i] = 0.5 * std::erfc((minSnirOffset + i * snirOffsetStep + 1.2816 * blockErrorRateDeviation) / (std::sqrt(2) * blockErrorRateDeviation));
+        return table;
+    }();
+    return table;
+}
+
+double LteErrorModel::computeReferenceSnir(LteModulation modulation, int codeRate)
+{
+    const LteCqi *lower = nullptr;
+    const LteCqi *upper = nullptr;
+    for (const auto& cqi : cqiTable) {
+        if (cqi.modulation != modulation)
+            continue;
+        if (cqi.codeRate <= codeRate)
+            lower = &cqi;
+        else if (upper == nullptr)
+            upper = &cqi;
+    }
+    // code rates outside the CQIs of the modulation are clamped
+    if (lower == nullptr)
+        return upper->referenceSnir;
+    else if (upper == nullptr)
+        return lower->referenceSnir;
+    else
+        return lower->referenceSnir + (upper->referenceSnir - lower->referenceSnir) * (codeRate - lower->codeRate) / (upper->codeRate - lower->codeRate);
+}
+
+double LteErrorModel::lookupBlockErrorRate(double referenceSnir, double snir) const
+{
+    const auto& table = getBlockErrorRateTable();
+    double position = (math::fraction2dB(snir) - referenceSnir - minSnirOffset) / snirOffsetStep;
+    if (!(position > 0))
+        return table.front();
+    else if (position >= table.size() - 1)
+        return table.back();
+    else {
+        int index = (int)position;
+        double alpha = position - index;
+        return table[index] + alpha * (table[index + 1] - table[index]);
+    }
+}
+
+double LteErrorModel::computeBlockErrorRate(const LteMode& mode, double snir, b length) const
+{
+    double resourceBlockErrorRate = lookupBlockErrorRate(computeReferenceSnir(mode.getModulation(), mode.getCodeRate()), snir);
+    return -std::expm1(length.get() / mode.getResourceBlockLength().get() * std::log1p(-resourceBlockErrorRate));
+}
+
+double LteErrorModel::computePacketErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const
+{
+    auto frame = check_and_cast<const Frame *>(snir->getReception()->getTransmission()->getPacket());
+    return computeBlockErrorRate(frame->getGrid().getMode(), snir->getMin(), frame->getTotalLength());
+}
+
+double LteErrorModel::computeBitErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const
+{
+    auto frame = check_and_cast<const Frame *>(snir->getReception()->getTransmission()->getPacket());
+    return computeBlockErrorRate(frame->getGrid().getMode(), snir->getMin(), b(1));
+}
+
+double LteErrorModel::computeSymbolErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const
+{
+    auto frame = check_and_cast<const Frame *>(snir->getReception()->getTransmission()->getPacket());
+    const auto& mode = frame->getGrid().getMode();
+    // a resource element carries coded bits, so it's an equal share of the resource block instead of a part of its payload
+    double resourceBlockErrorRate = computeBlockErrorRate(mode, snir->getMin(), mode.getResourceBlockLength());
+    return -std::expm1(std::log1p(-resourceBlockErrorRate) / mode.getNumResourceElementsPerResourceBlock());
+}
+
+void LteRadioMedium::initialize(int stage)
+{
+    RadioMedium::initialize(stage);
+    if (stage == INITSTAGE_LOCAL) {
+        indexTransmissions = par("indexTransmissions");
+        interferenceRange = m(par("interferenceRange")).get();
+        maxPropagationDelay = par("maxPropagationDelay");
+        indexTimeStep = par("indexTimeStep");
+        if (!(indexTimeStep > 0))
+            throw cRuntimeError("Invalid index time step: %g", indexTimeStep);
+        if (indexTransmissions)
+            subscribe(signalRemovedSignal, this);
+        int numThreads = par("numThreads");
+        if (numThreads > 0)
+            workerPool = new WorkerPool(numThreads);
+    }
+    else if (stage == INITSTAGE_LAST && indexTransmissions) {
+        // the index would silently drop interference which arrives later than the bound, so it must hold across the constraint area
+        double maxDistance = mediumLimitCache->getMinConstraintArea().distance(mediumLimitCache->getMaxConstraintArea());
+        if (!std::isfinite(maxDistance))
+            throw cRuntimeError("Indexing transmissions requires a bounded constraint area");
+        double propagationDelay = maxDistance / propagation->getPropagationSpeed().get();
+        if (propagationDelay > maxPropagationDelay)
+            throw cRuntimeError("Propagation delay %g s across the constraint area exceeds the maximum propagation delay %g s", propagationDelay, maxPropagationDelay);
+    }
+}
+
+LteRadioMedium::~LteRadioMedium()
+{
+    for (auto& it : evaluatedReceptions)
+        delete it.second.interference;
+    delete workerPool;
+}
+
+std::pair<int, int> LteRadioMedium::getCell(const Coord& position) const
+{
+    if (std::isnan(interferenceRange))
+        return {0, 0};
+    else
+        return {(int)std::floor(position.x / interferenceRange), (int)std::floor(position.y / interferenceRange)};
+}
+
+IndexedTransmission LteRadioMedium::createIndexedTransmission(const ITransmission *transmission) const
+{
+    IndexedTransmission indexedTransmission;
+    indexedTransmission.transmission = transmission;
+    indexedTransmission.transmissionId = transmission->getId();
+    indexedTransmission.startTime = transmission->getStartTime().dbl();
+    indexedTransmission.endTime = transmission->getEndTime().dbl() + maxPropagationDelay;
+    indexedTransmission.position = transmission->getStartPosition();
+    if (auto lteTransmission = dynamic_cast<const LteTransmission *>(transmission)) {
+        indexedTransmission.minFrequency = lteTransmission->getMinFrequency().get();
+        indexedTransmission.maxFrequency = lteTransmission->getMaxFrequency().get();
+    }
+    else if (auto narrowbandSignal = dynamic_cast<const INarrowbandSignal *>(transmission)) {
+        indexedTransmission.minFrequency = (narrowbandSignal->getCarrierFrequency() - narrowbandSignal->getBandwidth() / 2).get();
+        indexedTransmission.maxFrequency = (narrowbandSignal->getCarrierFrequency() + narrowbandSignal->getBandwidth() / 2).get();
+    }
+    return indexedTransmission;
+}
+
+void LteRadioMedium::addTransmission(const IRadio *transmitter, const ITransmission *transmission)
+{
+    RadioMedium::addTransmission(transmitter, transmission);
+    if (indexTransmissions) {
+        auto indexedTransmission = createIndexedTransmission(transmission);
+        auto cell = getCell(indexedTransmission.position);
+        long firstTimeStep = (long)std::floor(indexedTransmission.startTime / indexTimeStep);
+        long lastTimeStep = (long)std::floor(indexedTransmission.endTime / indexTimeStep);
+        for (long i = firstTimeStep; i <= lastTimeStep; i++)
+            index[i][cell].push_back(indexedTransmission);
+    }
+    if (workerPool != nullptr)
+        invalidateEvaluatedReceptions(transmission);
+    if (workerPool != nullptr && dynamic_cast<const LteTransmission *>(transmission) != nullptr) {
+        // all receptions of the transmission are evaluated together when the first of them ends
+        std::vector<std::pair<const IRadio *, const ITransmission *>> receptions;
+        simtime_t firstEndTime = SimTime::getMaxTime();
+        for (auto radio : radios) {
+            if (radio == nullptr || radio == transmitter || dynamic_cast<const LteReceiver *>(radio->getReceiver()) == nullptr)
+                continue;
+            auto arrival = getArrival(radio, transmission);
+            if (arrival == nullptr)
+                continue;
+            firstEndTime = std::min(firstEndTime, arrival->getEndTime());
+            receptions.push_back({radio, transmission});
+        }
+        if (!receptions.empty()) {
+            auto& pendingTransmissionReceptions = pendingReceptions[firstEndTime];
+            pendingTransmissionReceptions.insert(pendingTransmissionReceptions.end(), receptions.begin(), receptions.end());
+        }
+    }
+}
+
+void LteRadioMedium::removeIndexedTransmission(const ITransmission *transmission)
+{
+    // the buckets are found the same way as they were when the transmission was added
+    auto indexedTransmission = createIndexedTransmission(transmission);
+    auto cell = getCell(indexedTransmission.position);
+    long firstTimeStep = (long)std::floor(indexedTransmission.startTime / indexTimeStep);
+    long lastTimeStep = (long)std::floor(indexedTransmission.endTime / indexTimeStep);
+    for (long i = firstTimeStep; i <= lastTimeStep; i++) {
+        auto it = index.find(i);
+        if (it == index.end())
+            continue;
+        auto jt = it->second.find(cell);
+        if (jt != it->second.end()) {
+            auto& indexedTransmissions = jt->second;
+            indexedTransmissions.erase(std::remove_if(indexedTransmissions.begin(), indexedTransmissions.end(), [&] (const IndexedTransmission& other) { return other.transmission == transmission; }), indexedTransmissions.end());
+            if (indexedTransmissions.empty())
+                it->second.erase(jt);
+        }
+        if (it->second.empty())
+            index.erase(it);
+    }
+}
+
+void LteRadioMedium::receiveSignal(cComponent *source, simsignal_t signal, cObject *value, cObject *details)
+{
+    // the base class emits this signal right before it deletes the transmission
+    if (signal == signalRemovedSignal) {
+        if (auto transmission = dynamic_cast<const ITransmission *>(value))
+            removeIndexedTransmission(transmission);
+    }
+    else
+        RadioMedium::receiveSignal(source, signal, value, details);
+}
+
+void LteRadioMedium::collectInterferingTransmissions(const IListening *listening, double minFrequency, double maxFrequency, std::vector<const ITransmission *>& interferingTransmissions) const
+{
+    double startTime = listening->getStartTime().dbl();
+    double endTime = listening->getEndTime().dbl();
+    auto position = listening->getStartPosition();
+    auto cell = getCell(position);
+    // the cell size is the interference range, so only the neighboring cells can contain interferers
+    int cellRadius = std::isnan(interferenceRange) ? 0 : 1;
+    std::vector<const IndexedTransmission *> indexedTransmissions;
+    auto it = index.lower_bound((long)std::floor(startTime / indexTimeStep));
+    auto jt = index.upper_bound((long)std::floor(endTime / indexTimeStep));
+    for (; it != jt; it++) {
+        for (int x = cell.first - cellRadius; x <= cell.first + cellRadius; x++) {
+            for (int y = cell.second - cellRadius; y <= cell.second + cellRadius; y++) {
+                auto kt = it->second.find({x, y});
+                if (kt != it->second.end()) {
+                    for (const auto& indexedTransmission : kt->second) {
+                        if (indexedTransmission.endTime < startTime || indexedTransmission.startTime > endTime)
+                            continue;
+                        if (!std::isnan(interferenceRange) && indexedTransmission.position.distance(position) > interferenceRange)
+                            continue;
+                        if (!std::isnan(minFrequency) && !std::isnan(indexedTransmission.minFrequency) && (indexedTransmission.maxFrequency <= minFrequency || indexedTransmission.minFrequency >= maxFrequency))
+                            continue;
+                        indexedTransmissions.push_back(&indexedTransmission);
                     }
-                    resourceBlock.setContent(resourceBlockContent);
-                    slotContent->insertAtBack(resourceBlockContent);
-                }
-                else {
-                    const auto& content = resourceBlock.getContent();
-                    if (content != nullptr)
-                        slotContent->insertAtBack(content);
                 }
             }
-            slot.setContent(slotContent);
-            subframeContent->insertAtBack(slotContent);
         }
-        subframe.setContent(subframeContent);
-        frameContent->insertAtBack(subframeContent);
     }
-    frame.setContent(frameContent);
+    // transmissions spanning several time steps are found multiple times
+    std::sort(indexedTransmissions.begin(), indexedTransmissions.end(), [] (const IndexedTransmission *a, const IndexedTransmission *b) { return a->transmissionId < b->transmissionId; });
+    for (auto indexedTransmission : indexedTransmissions)
+        if (interferingTransmissions.empty() || interferingTransmissions.back() != indexedTransmission->transmission)
+            interferingTransmissions.push_back(indexedTransmission->transmission);
 }
 
-} // namespace lte
+const IInterference *LteRadioMedium::computeInterference(const IRadio *receiver, const IListening *listening, const std::vector<const ITransmission *> *transmissions) const
+{
+    if (!indexTransmissions)
+        return RadioMedium::computeInterference(receiver, listening, transmissions);
+    std::vector<const ITransmission *> interferingTransmissions;
+    collectInterferingTransmissions(listening, NaN, NaN, interferingTransmissions);
+    return RadioMedium::computeInterference(receiver, listening, &interferingTransmissions);
+}
+
+const IInterference *LteRadioMedium::computeInterference(const IRadio *receiver, const IListening *listening, const ITransmission *transmission, const std::vector<const ITransmission *> *transmissions) const
+{
+    if (!indexTransmissions)
+        return RadioMedium::computeInterference(receiver, listening, transmission, transmissions);
+    // signals outside the allocated resource blocks don't interfere with the reception
+    std::vector<const ITransmission *> interferingTransmissions;
+    if (auto lteTransmission = dynamic_cast<const LteTransmission *>(transmission))
+        collectInterferingTransmissions(listening, lteTransmission->getMinFrequency().get(), lteTransmission->getMaxFrequency().get(), interferingTransmissions);
+    else
+        collectInterferingTransmissions(listening, NaN, NaN, interferingTransmissions);
+    return RadioMedium::computeInterference(receiver, listening, transmission, &interferingTransmissions);
+}
+
+const IInterference *LteRadioMedium::getInterference(const IRadio *receiver, const ITransmission *transmission) const
+{
+    if (workerPool != nullptr) {
+        evaluateReceptions();
+        // the interference of the evaluation is still valid, the base class finds it in the cache
+        auto it = evaluatedReceptions.find({receiver->getId(), transmission->getId()});
+        if (it != evaluatedReceptions.end() && it->second.interference != nullptr) {
+            if (communicationCache->getCachedInterference(receiver, transmission) == nullptr)
+                communicationCache->setCachedInterference(receiver, transmission, it->second.interference);
+            else
+                delete it->second.interference;
+            it->second.interference = nullptr;
+        }
+    }
+    return RadioMedium::getInterference(receiver, transmission);
+}
 
+bool LteRadioMedium::takeErroneousResourceBlocks(const IRadio *receiver, const ITransmission *transmission, std::vector<bool>& erroneousResourceBlocks) const
+{
+    if (workerPool == nullptr)
+        return false;
+    auto it = evaluatedReceptions.find({receiver->getId(), transmission->getId()});
+    if (it == evaluatedReceptions.end())
+        return false;
+    erroneousResourceBlocks = std::move(it->second.erroneousResourceBlocks);
+    delete it->second.interference;
+    evaluatedReceptions.erase(it);
+    return true;
+}
+
+void LteRadioMedium::invalidateEvaluatedReceptions(const ITransmission *transmission)
+{
+    // the evaluations of the receptions which the new transmission may interfere with are outdated
+    for (auto it = evaluatedReceptions.begin(); it != evaluatedReceptions.end();) {
+        if (it->second.interference != nullptr && it->second.endTime >= transmission->getStartTime()) {
+            delete it->second.interference;
+            it = evaluatedReceptions.erase(it);
+        }
+        else
+            it++;
+    }
+}
+
+void LteRadioMedium::evaluateReceptions() const
+{
+    if (pendingReceptions.empty() || pendingReceptions.begin()->first > simTime())
+        return;
+    // receptions which were evaluated but never asked for are dropped after they ended
+    for (auto it = evaluatedReceptions.begin(); it != evaluatedReceptions.end();) {
+        if (it->second.endTime < simTime()) {
+            delete it->second.interference;
+            it = evaluatedReceptions.erase(it);
+        }
+        else
+            it++;
+    }
+    std::vector<const IRadio *> receiverRadios;
+    std::vector<const ITransmission *> transmissions;
+    std::vector<const LteReceiver *> receivers;
+    std::vector<const IListening *> listenings;
+    std::vector<const IReception *> receptions;
+    auto end = pendingReceptions.upper_bound(simTime());
+    for (auto it = pendingReceptions.begin(); it != end; it++) {
+        for (const auto& pendingReception : it->second) {
+            auto radio = pendingReception.first;
+            auto transmission = pendingReception.second;
+            auto reception = getReception(radio, transmission);
+            if (reception->getEndTime() < simTime())
+                continue;
+            receiverRadios.push_back(radio);
+            transmissions.push_back(transmission);
+            receivers.push_back(check_and_cast<const LteReceiver *>(radio->getReceiver()));
+            listenings.push_back(getListening(radio, transmission));
+            receptions.push_back(reception);
+        }
+    }
+    pendingReceptions.erase(pendingReceptions.begin(), end);
+    std::vector<char> isReceptionPossible(receivers.size());
+    workerPool->run(receivers.size(), [&] (int i) {
+        isReceptionPossible[i] = receivers[i]->computeIsReceptionPossible(listenings[i], receptions[i], IRadioSignal::SIGNAL_PART_WHOLE);
+    });
+    // the interference is computed on the simulation thread, because the base class updates its counters
+    std::vector<const IInterference *> interferences(receivers.size(), nullptr);
+    for (size_t i = 0; i < receivers.size(); i++)
+        if (isReceptionPossible[i])
+            interferences[i] = computeInterference(receiverRadios[i], listenings[i], transmissions[i], communicationCache->getTransmissions());
+    std::vector<std::vector<bool>> erroneousResourceBlocks(receivers.size());
+    workerPool->run(receivers.size(), [&] (int i) {
+        if (isReceptionPossible[i])
+            receivers[i]->computeErroneousResourceBlocks(receptions[i], interferences[i], erroneousResourceBlocks[i]);
+    });
+    for (size_t i = 0; i < receivers.size(); i++) {
+        if (!isReceptionPossible[i])
+            continue;
+        auto& evaluatedReception = evaluatedReceptions[{receiverRadios[i]->getId(), transmissions[i]->getId()}];
+        evaluatedReception.endTime = receptions[i]->getEndTime();
+        evaluatedReception.interference = interferences[i];
+        evaluatedReception.erroneousResourceBlocks = std::move(erroneousResourceBlocks[i]);
+    }
+}
+
+} // namespace lte
@@ -16,168 +16,272 @@
 #ifndef __LTE_PHY_H_
 #define __LTE_PHY_H_
 
+#include <chrono>
+#include <deque>
 #include "inet/common/packet/chunk/EmptyChunk.h"
+#include "inet/common/packet/chunk/SequenceChunk.h"
+#include "inet/common/packet/chunk/SliceChunk.h"
 #include "inet/common/packet/Packet.h"
+#include "inet/linklayer/common/MacAddress.h"
 #include "inet/physicallayer/base/packetlevel/ErrorModelBase.h"
 #include "inet/physicallayer/base/packetlevel/NarrowbandTransmissionBase.h"
 #include "inet/physicallayer/base/packetlevel/ReceiverBase.h"
 #include "inet/physicallayer/base/packetlevel/TransmitterBase.h"
 #include "inet/physicallayer/common/packetlevel/Radio.h"
+#include "inet/physicallayer/common/packetlevel/RadioMedium.h"
 #include "inet/physicallayer/contract/packetlevel/IRadioSignal.h"
-#include "inet/physicallayer/modulation/Qam64Modulation.h"
 
 namespace lte {
 
 using namespace inet;
 using namespace inet::physicallayer;
 
+/**
+ * Determines the granularity of the content stored in a frame. Coarser levels
+ * are cheaper to simulate, but they provide less information about the frame.
+ */
 enum class LevelOfDetail {
-//    FRAME,
-//    SUBFRAME,
-//    SLOT,
+    FRAME,
+    SUBFRAME,
+    SLOT,
     RESOURCE_BLOCK,
     RESOURCE_ELEMENT
 };
 
+/**
+ * Determines the number of subcarriers and resource blocks of a slot.
+ */
+enum class LteBandwidth {
+    MHZ_1_4,
+    MHZ_3,
+    MHZ_5,
+    MHZ_10,
+    MHZ_15,
+    MHZ_20
+};
+
+/**
+ * Determines the number of symbols of a slot.
+ */
+enum class LteCyclicPrefix {
+    NORMAL,
+    EXTENDED
+};
+
+/**
+ * Determines the number of bits carried by a resource element.
+ */
+enum class LteModulation {
+    QPSK,
+    QAM16,
+    QAM64
+};
+
+/**
+ * Represents the numerology, the modulation, and the coding of an LTE channel.
+ * A resource element carries as many coded bits as its modulation allows, and
+ * a resource block carries the code rate fraction of its coded bits as
+ * payload. The derived values are computed by the constructor, so the getters
+ * only return members, and a mode constructed from constants is a compile
+ * time constant.
+ */
 class LteMode {
   protected:
-    const int numSubframesPerFrame = 10;
-    const int numSlotsPerSubframe = 2;
-    const int numSubcarriersPerSlot = 2048; // from 128 to 2048
-    const int numOccupiedSubcarriersPerSlot = 1200; // from 76 to 1200
-    const int numSymbolsPerResourceBlock = 7; // either 7 or 6
-    const int numSubcarriersPerResourceBlock = 12;
-    const IApskModulation &subcarrierModulation = Qam64Modulation::singleton; // QPSK, QAM-16, or QAM-64
+    LteBandwidth bandwidth;
+    LteCyclicPrefix cyclicPrefix;
+    LteModulation modulation;
+    int codeRate; // in 1/1024 units as in the CQI table of 3GPP TS 36.213
+    int numSubframesPerFrame;
+    int numSlotsPerSubframe;
+    int numSubcarriersPerSlot; // from 128 to 2048
+    int numOccupiedSubcarriersPerSlot; // from 72 to 1200
+    int numSymbolsPerResourceBlock; // either 7 or 6
+    int numSubcarriersPerResourceBlock;
+    int numResourceBlocksPerSlot;
+    int numResourceElementsPerResourceBlock;
+    int numBitsPerResourceElement; // 2, 4, or 6
+    int numBitsPerResourceBlock; // payload after coding
+    double resourceElementDuration; // in seconds including the cyclic prefix
+    double resourceBlockDuration; // in seconds
+
+  protected:
+    static constexpr int computeNumSubcarriersPerSlot(LteBandwidth bandwidth) {
+        return bandwidth == LteBandwidth::MHZ_1_4 ? 128 : bandwidth == LteBandwidth::MHZ_3 ? 256 : bandwidth == LteBandwidth::MHZ_5 ? 512 :
+               bandwidth == LteBandwidth::MHZ_10 ? 1024 : bandwidth == LteBandwidth::MHZ_15 ? 1536 : 2048;
+    }
+    static constexpr int computeNumResourceBlocksPerSlot(LteBandwidth bandwidth) {
+        return bandwidth == LteBandwidth::MHZ_1_4 ? 6 : bandwidth == LteBandwidth::MHZ_3 ? 15 : bandwidth == LteBandwidth::MHZ_5 ? 25 :
+               bandwidth == LteBandwidth::MHZ_10 ? 50 : bandwidth == LteBandwidth::MHZ_15 ? 75 : 100;
+    }
+    static constexpr int computeNumSymbolsPerResourceBlock(LteCyclicPrefix cyclicPrefix) { return cyclicPrefix == LteCyclicPrefix::NORMAL ? 7 : 6; }
+    static constexpr int computeNumBitsPerResourceElement(LteModulation modulation) { return modulation == LteModulation::QPSK ? 2 : modulation == LteModulation::QAM16 ? 4 : 6; }
+    // the code rate of the highest CQI using the modulation
+    static constexpr int computeMaxCodeRate(LteModulation modulation) { return modulation == LteModulation::QPSK ? 602 : modulation == LteModulation::QAM16 ? 616 : 948; }
+    static constexpr int computeNumBitsPerResourceBlock(LteCyclicPrefix cyclicPrefix, LteModulation modulation, int codeRate) { return 12 * computeNumSymbolsPerResourceBlock(cyclicPrefix) * computeNumBitsPerResourceElement(modulation) * codeRate / 1024; }
+    // the durations are independent of the bandwidth, they are given in samples of the 20 MHz channel
+    static constexpr double computeResourceElementDuration(LteCyclicPrefix cyclicPrefix) { return (2048.0 + (cyclicPrefix == LteCyclicPrefix::NORMAL ? 144 : 512)) / 30720000; }
+    static constexpr double computeResourceBlockDuration(LteCyclicPrefix cyclicPrefix) { return computeNumSymbolsPerResourceBlock(cyclicPrefix) * computeResourceElementDuration(cyclicPrefix) + (cyclicPrefix == LteCyclicPrefix::NORMAL ? 160.0 - 144 : 0.0) / 30720000; }
 
   public:
-    int getNumSubframesPerFrame() const { return numSubframesPerFrame; }
-    int getNumSlotsPerSubframe() const { return numSlotsPerSubframe; }
-    int getNumSubcarriersPerSlot() const { return numSubcarriersPerSlot; }
-    int getNumOccupiedSubcarriersPerSlot() const { return numOccupiedSubcarriersPerSlot; }
-    int getNumSymbolsPerResourceBlock() const { return numSymbolsPerResourceBlock; }
-    int getNumSubcarriersPerResourceBlock() const { return numSubcarriersPerResourceBlock; }
-    int getNumResourceBlocksPerSlot() const { return getNumOccupiedSubcarriersPerSlot() / getNumSubcarriersPerResourceBlock(); }
-    int getNumResourceElementsPerResourceBlock() const { return getNumSubcarriersPerResourceBlock() * getNumSymbolsPerResourceBlock(); }
-
-    b getFrameLength() const { return getSubframeLength() * getNumSubframesPerFrame(); }
-    b getSubframeLength() const { return getSlotLength() * getNumSlotsPerSubframe(); }
-    b getSlotLength() const { return getResourceBlockLength() * getNumResourceBlocksPerSlot(); }
-    b getResourceBlockLength() const { return getResourceElementLength() * getNumResourceElementsPerResourceBlock(); }
-    b getResourceElementLength() const { return B(1); } // return b(subcarrierModulation.getCodeWordSize()); }
-
-    simtime_t getResourceElementDuration() const { return (double)(2048 + 144) / 30720000; }
-    simtime_t getResourceBlockDuration() const { return getNumSymbolsPerResourceBlock() * getResourceElementDuration() + (double)(160 - 144) / 30720000; }
+    constexpr LteMode(LteBandwidth bandwidth = LteBandwidth::MHZ_20, LteCyclicPrefix cyclicPrefix = LteCyclicPrefix::NORMAL, LteModulation modulation = LteModulation::QAM64, int codeRate = 0) :
+        bandwidth(bandwidth),
+        cyclicPrefix(cyclicPrefix),
+        modulation(modulation),
+        codeRate(codeRate == 0 ? computeMaxCodeRate(modulation) : codeRate),
+        numSubframesPerFrame(10),
+        numSlotsPerSubframe(2),
+        numSubcarriersPerSlot(computeNumSubcarriersPerSlot(bandwidth)),
+        numOccupiedSubcarriersPerSlot(computeNumResourceBlocksPerSlot(bandwidth) * 12),
+        numSymbolsPerResourceBlock(computeNumSymbolsPerResourceBlock(cyclicPrefix)),
+        numSubcarriersPerResourceBlock(12),
+        numResourceBlocksPerSlot(computeNumResourceBlocksPerSlot(bandwidth)),
+        numResourceElementsPerResourceBlock(12 * computeNumSymbolsPerResourceBlock(cyclicPrefix)),
+        numBitsPerResourceElement(computeNumBitsPerResourceElement(modulation)),
+        numBitsPerResourceBlock(computeNumBitsPerResourceBlock(cyclicPrefix, modulation, codeRate == 0 ? computeMaxCodeRate(modulation) : codeRate)),
+        resourceElementDuration(computeResourceElementDuration(cyclicPrefix)),
+        resourceBlockDuration(computeResourceBlockDuration(cyclicPrefix)) { }
+
+    constexpr LteBandwidth getChannelBandwidth() const { return bandwidth; }
+    constexpr LteCyclicPrefix getCyclicPrefix() const { return cyclicPrefix; }
+    constexpr LteModulation getModulation() const { return modulation; }
+    constexpr int getCodeRate() const { return codeRate; }
+
+    constexpr int getNumSubframesPerFrame() const { return numSubframesPerFrame; }
+    constexpr int getNumSlotsPerSubframe() const { return numSlotsPerSubframe; }
+    constexpr int getNumSlotsPerFrame() const { return numSubframesPerFrame * numSlotsPerSubframe; }
+    constexpr int getSlotIndex(int subframeIndex, int slotIndex) const { return subframeIndex * numSlotsPerSubframe + slotIndex; } // counted from the beginning of the frame
+    constexpr int getNumSubcarriersPerSlot() const { return numSubcarriersPerSlot; }
+    constexpr int getNumOccupiedSubcarriersPerSlot() const { return numOccupiedSubcarriersPerSlot; }
+    constexpr int getNumSymbolsPerResourceBlock() const { return numSymbolsPerResourceBlock; }
+    constexpr int getNumSubcarriersPerResourceBlock() const { return numSubcarriersPerResourceBlock; }
+    constexpr int getNumResourceBlocksPerSlot() const { return numResourceBlocksPerSlot; }
+    constexpr int getNumResourceElementsPerResourceBlock() const { return numResourceElementsPerResourceBlock; }
+
+    Hz getSubcarrierSpacing() const { return kHz(15); }
+    Hz getResourceBlockBandwidth() const { return getSubcarrierSpacing() * numSubcarriersPerResourceBlock; }
+    Hz getBandwidth() const { return getResourceBlockBandwidth() * numResourceBlocksPerSlot; } // occupied by the resource blocks
+
+    b getFrameLength() const { return getSubframeLength() * numSubframesPerFrame; }
+    b getSubframeLength() const { return getSlotLength() * numSlotsPerSubframe; }
+    b getSlotLength() const { return getResourceBlockLength() * numResourceBlocksPerSlot; }
+    b getResourceBlockLength() const { return b(numBitsPerResourceBlock); } // payload, less than the coded bits of the resource elements
+    b getResourceElementLength() const { return b(numBitsPerResourceElement); } // coded bits
+
+    simtime_t getResourceElementDuration() const { return resourceElementDuration; }
+    simtime_t getResourceBlockDuration() const { return resourceBlockDuration; }
     simtime_t getSlotDuration() const { return 5E-4; }
     simtime_t getSubframeDuration() const { return 1E-3; }
     simtime_t getFrameDuration() const { return 10E-3; }
 };
 
+static_assert(LteMode().getNumResourceBlocksPerSlot() == 100 && LteMode().getNumResourceElementsPerResourceBlock() == 84, "Unexpected default LTE mode");
+static_assert(LteMode(LteBandwidth::MHZ_1_4, LteCyclicPrefix::EXTENDED).getNumOccupiedSubcarriersPerSlot() == 72, "Unexpected 1.4 MHz LTE mode");
+
+class ResourceGrid;
+class Frame;
+
 /**
- * Represents one OFDM symbol using one subcarrier.
+ * Base class of the views into the resource grid of a frame. A read-only view
+ * refers to the grid directly. A modifiable view refers to the frame, and the
+ * grid is looked up on every access, so writing through the view copies the
+ * grid first if it's shared with other frames.
  */
-class ResourceElement {
+class ResourceGridView {
   protected:
-    Ptr<const Chunk> content; // this level of detail is optional
+    const ResourceGrid *grid; // only for read-only views
+    Frame *frame; // only for modifiable views
 
-  public:
-    const Chunk *getContentPtr() { return content.get(); } // only for class descriptor
+  protected:
+    inline const ResourceGrid *getGrid() const;
+    inline ResourceGrid *getGridForUpdate() const;
 
   public:
-    ResourceElement(LevelOfDetail levelOfDetail) { ASSERT(levelOfDetail == LevelOfDetail::RESOURCE_ELEMENT); }
-    ResourceElement(const ResourceElement& other) { content = other.content; }
-    void operator=(const ResourceElement& other) { content = other.content; }
-
-    Ptr<const Chunk> getContent() const { return content; }
-    void setContent(Ptr<const Chunk> content) { this->content = content; }
+    ResourceGridView(const ResourceGrid *grid, Frame *frame) : grid(grid), frame(frame) { }
 };
 
 /**
- * Represents multiple OFDM symbols over multiple subcarriers.
+ * Represents one OFDM symbol using one subcarrier. This is a view into the
+ * resource grid of a frame.
  */
-class ResourceBlock {
+class ResourceElement : public ResourceGridView {
   protected:
-    std::vector<ResourceElement> resourceElements; // this level of detail is optional
-    Ptr<const Chunk> content;
+    int slotIndex;
+    int resourceBlockIndex;
+    int resourceElementIndex;
+
+    Ptr<const Chunk> descriptorContent; // only for class descriptor
 
   public:
-    const Chunk *getContentPtr() { return content.get(); } // only for class descriptor
-    int getResourceElementsArraySize() const { return resourceElements.size(); } // only for class descriptor
+    const Chunk *getContentPtr() { descriptorContent = getContent(); return descriptorContent.get(); } // only for class descriptor
 
   public:
-    ResourceBlock(LteMode& mode, LevelOfDetail levelOfDetail) { if (levelOfDetail > LevelOfDetail::RESOURCE_BLOCK) for (int i = 0; i < mode.getNumResourceElementsPerResourceBlock(); i++) resourceElements.push_back(ResourceElement(levelOfDetail)); }
-    ResourceBlock(const ResourceBlock& other) { content = other.content; resourceElements = other.resourceElements; }
-    void operator=(const ResourceBlock& other) { content = other.content; resourceElements = other.resourceElements; }
+    ResourceElement(const ResourceGrid *grid, Frame *frame, int slotIndex, int resourceBlockIndex, int resourceElementIndex) : ResourceGridView(grid, frame), slotIndex(slotIndex), resourceBlockIndex(resourceBlockIndex), resourceElementIndex(resourceElementIndex) { }
 
-    ResourceElement& getResourceElement(int index) { return resourceElements[index]; }
-    Ptr<const Chunk> getContent() const { return content; }
-    void setContent(Ptr<const Chunk> content) { this->content = content; }
+    inline Ptr<const Chunk> getContent() const;
+    inline void setContent(Ptr<const Chunk> content);
 };
 
 /**
- * Represents multiple resource blocks over all subcarriers.
+ * Represents multiple OFDM symbols over multiple subcarriers. This is a view
+ * into the resource grid of a frame.
  */
-class Slot {
+class ResourceBlock : public ResourceGridView {
   protected:
-    std::vector<ResourceBlock> resourceBlocks;
-    Ptr<const Chunk> content; // this aggregate is optional
+    int slotIndex;
+    int resourceBlockIndex;
+
+    Ptr<const Chunk> descriptorContent; // only for class descriptor
 
   public:
-    const Chunk *getContentPtr() { return content.get(); } // only for class descriptor
-    int getResourceBlocksArraySize() const { return resourceBlocks.size(); } // only for class descriptor
+    const Chunk *getContentPtr() { descriptorContent = getContent(); return descriptorContent.get(); } // only for class descriptor
+    inline int getResourceElementsArraySize() const; // only for class descriptor
+    inline ResourceElement *getResourceElementPtr(int index); // only for class descriptor
 
   public:
-    Slot(LteMode& mode, LevelOfDetail levelOfDetail) { for (int i = 0; i < mode.getNumResourceBlocksPerSlot(); i++) resourceBlocks.push_back(ResourceBlock(mode, levelOfDetail)); }
-    Slot(const Slot& other) { content = other.content; resourceBlocks = other.resourceBlocks; }
-    void operator=(const Slot& other) { content = other.content; resourceBlocks = other.resourceBlocks; }
+    ResourceBlock(const ResourceGrid *grid, Frame *frame, int slotIndex, int resourceBlockIndex) : ResourceGridView(grid, frame), slotIndex(slotIndex), resourceBlockIndex(resourceBlockIndex) { }
 
-    ResourceBlock& getResourceBlock(int index) { return resourceBlocks[index]; }
-    Ptr<const Chunk> getContent() const { return content; }
-    void setContent(Ptr<const Chunk> content) { this->content = content; }
+    ResourceElement getResourceElement(int index) const { return ResourceElement(grid, frame, slotIndex, resourceBlockIndex, index); }
+    inline Ptr<const Chunk> getContent() const;
+    inline void setContent(Ptr<const Chunk> content);
 };
 
 /**
- * Represents multiple slots.
+ * Represents multiple resource blocks over all subcarriers. This is a view
+ * into the resource grid of a frame.
  */
-class Subframe {
+class Slot : public ResourceGridView {
   protected:
-    std::vector<Slot> slots;
-    Ptr<const Chunk> content; // this aggregate is optional
+    int slotIndex; // counted from the beginning of the frame
 
   public:
-    const Chunk *getContentPtr() { return content.get(); } // only for class descriptor
-    int getSlotsArraySize() const { return slots.size(); } // only for class descriptor
+    const Chunk *getContentPtr() { return getContent().get(); } // only for class descriptor
+    inline int getResourceBlocksArraySize() const; // only for class descriptor
+    inline ResourceBlock *getResourceBlockPtr(int index); // only for class descriptor
 
   public:
-    Subframe(LteMode& mode, LevelOfDetail levelOfDetail) { for (int i = 0; i < mode.getNumSlotsPerSubframe(); i++) slots.push_back(Slot(mode, levelOfDetail)); }
-    Subframe(const Subframe& other) { content = other.content; slots = other.slots; }
-    void operator=(const Subframe& other) { content = other.content; slots = other.slots; }
+    Slot(const ResourceGrid *grid, Frame *frame, int slotIndex) : ResourceGridView(grid, frame), slotIndex(slotIndex) { }
 
-    Slot& getSlot(int index) { return slots[index]; }
-    Ptr<const Chunk> getContent() const { return content; }
-    void setContent(Ptr<const Chunk> content) { this->content = content; }
+    ResourceBlock getResourceBlock(int index) const { return ResourceBlock(grid, frame, slotIndex, index); }
+    inline Ptr<const Chunk> getContent() const;
 };
 
 /**
- * Represents multiple subframes.
+ * Represents multiple slots. This is a view into the resource grid of a frame.
  */
-class Frame : public Packet {
+class Subframe : public ResourceGridView {
   protected:
-    std::vector<Subframe> subframes;
+    int subframeIndex;
 
   public:
-    int getSubframesArraySize() const { return subframes.size(); } // only for class descriptor
+    const Chunk *getContentPtr() { return getContent().get(); } // only for class descriptor
+    inline int getSlotsArraySize() const; // only for class descriptor
+    inline Slot *getSlotPtr(int index); // only for class descriptor
 
   public:
-    Frame(LteMode& mode, LevelOfDetail levelOfDetail) { for (int i = 0; i < mode.getNumSubframesPerFrame(); i++) subframes.push_back(Subframe(mode, levelOfDetail)); setDuration(10E-3); }
-    Frame(const Frame& other) : Packet(other) { subframes = other.subframes; }
-    Frame(const char *name, const Ptr<const Chunk>& content) : Packet(name, content) { setDuration(10E-3); }
-    void operator=(const Frame& other) { Packet::operator=(other); subframes = other.subframes; }
+    Subframe(const ResourceGrid *grid, Frame *frame, int subframeIndex) : ResourceGridView(grid, frame), subframeIndex(subframeIndex) { }
 
-    virtual Frame *dup() const override { return new Frame(*this); }
-
-    Subframe& getSubframe(int index) { return subframes[index]; }
-    Ptr<const Chunk> getContent() const { return peekAll(); }
-    void setContent(Ptr<const Chunk> content) { removeAll(); insertAtBack(content); }
+    inline Slot getSlot(int index) const;
+    inline Ptr<const Chunk> getContent() const;
 };
 
 /**
@@ -190,46 +294,408 @@ class AllocatedResourceBlock {
     int resourceBlockIndex = -1;
 };
 
+/**
+ * Represents a part of an upper layer packet carried in a frame. A packet
+ * that doesn't fit into one frame is continued in the next one.
+ */
+class PacketSegment {
+  public:
+    b offset = b(-1); // the offset of the segment in the packet
+    b length = b(-1);
+    b packetLength = b(-1);
+};
+
+/**
+ * Represents the resource blocks allocated to one destination within a frame.
+ * The segments follow each other in the order of the resource blocks.
+ */
+class ResourceAllocation {
+  public:
+    MacAddress source;
+    MacAddress destination;
+    std::vector<AllocatedResourceBlock> resourceBlocks;
+    std::vector<PacketSegment> segments;
+};
+
+/**
+ * Represents a content that is spread over consecutive cells of a resource
+ * grid. Each cell carries the next cell length long part of the content.
+ */
+class ContentRun {
+  public:
+    Ptr<const Chunk> content;
+    int startCell = -1;
+    int numCells = 0;
+};
+
+/**
+ * Stores all contents of a frame in one contiguous array of cells. Each slot
+ * occupies a block of cells, which is only allocated when the slot is first
+ * written. Within a block, each resource block takes one cell, or one cell
+ * per resource element at RESOURCE_ELEMENT level. The cells of a resource
+ * element hold coded bits, so the payload of a resource block leaves its last
+ * resource elements empty. Cell indices are computed from precomputed
+ * strides. The resource block (at RESOURCE_ELEMENT level),
+ * slot, and subframe contents are aggregates, they are only computed when
+ * they are asked for, and they are cached until the grid is modified.
+ * Contents spanning several consecutive cells are stored as content runs,
+ * the contents of the individual cells are only sliced on demand. The grid
+ * also stores the resource allocations of the frame.
+ *
+ * At FRAME, SUBFRAME, and SLOT level there are no cells at all. The cell
+ * indices still address resource blocks, but only the content runs are
+ * stored, and they are split at the frame, subframe, or slot boundaries
+ * respectively.
+ */
+class ResourceGrid {
+  protected:
+    LteMode mode;
+    LevelOfDetail levelOfDetail;
+    int numSlots;
+    int resourceBlockStride; // number of cells per resource block
+    int slotStride; // number of cells per slot
+    int unitStride; // number of cells per frame, subframe, or slot at coarse levels of detail
+    b cellLength;
+    std::vector<int> slotOffsets; // first cell of each slot, -1 if not yet allocated
+    std::vector<int> blockSlots; // slot of each allocated block of cells
+    std::vector<Ptr<const Chunk>> cells; // contents set for individual cells
+    std::vector<int> cellRuns; // content run of each cell, -1 if the cell doesn't belong to a run
+    std::vector<ContentRun> runs;
+    std::map<int, int> runStarts; // content run by start cell, only at coarse levels of detail
+    std::vector<ResourceAllocation> allocations;
+    mutable std::vector<Ptr<const Chunk>> resourceBlockContents; // lazily computed aggregate, only at RESOURCE_ELEMENT level
+    mutable std::vector<Ptr<const Chunk>> slotContents; // lazily computed aggregate
+    mutable std::vector<Ptr<const Chunk>> subframeContents; // lazily computed aggregate
+
+    mutable std::map<int, Subframe> subframeViews; // only for class descriptor
+    mutable std::map<int, Slot> slotViews; // only for class descriptor
+    mutable std::map<int, ResourceBlock> resourceBlockViews; // only for class descriptor
+    mutable std::map<int, ResourceElement> resourceElementViews; // only for class descriptor
+
+  protected:
+    int allocateSlot(int slotIndex);
+    void addRun(int startCell, const Ptr<const Chunk>& content);
+    void invalidateContents(int cell);
+    void appendContents(Ptr<SequenceChunk>& content, int startCell, int endCell) const;
+    Ptr<const Chunk> computeContent(int startCell, int endCell) const;
+    Ptr<const Chunk> getRunContent(int runIndex, int startCell, int endCell) const;
+
+  public:
+    Subframe *getSubframeView(int subframeIndex) const; // only for class descriptor
+    Slot *getSlotView(int slotIndex) const; // only for class descriptor
+    ResourceBlock *getResourceBlockView(int slotIndex, int resourceBlockIndex) const; // only for class descriptor
+    ResourceElement *getResourceElementView(int slotIndex, int resourceBlockIndex, int resourceElementIndex) const; // only for class descriptor
+
+  public:
+    ResourceGrid(const LteMode& mode, LevelOfDetail levelOfDetail);
+    ResourceGrid(const ResourceGrid& other) : mode(other.mode), levelOfDetail(other.levelOfDetail), numSlots(other.numSlots), resourceBlockStride(other.resourceBlockStride), slotStride(other.slotStride), unitStride(other.unitStride), cellLength(other.cellLength), slotOffsets(other.slotOffsets), blockSlots(other.blockSlots), cells(other.cells), cellRuns(other.cellRuns), runs(other.runs), runStarts(other.runStarts), allocations(other.allocations), resourceBlockContents(other.resourceBlockContents), slotContents(other.slotContents), subframeContents(other.subframeContents) { }
+    ResourceGrid& operator=(const ResourceGrid& other);
+
+    const LteMode& getMode() const { return mode; }
+    LevelOfDetail getLevelOfDetail() const { return levelOfDetail; }
+    bool isCoarse() const { return levelOfDetail < LevelOfDetail::RESOURCE_BLOCK; }
+    int getNumSlots() const { return numSlots; }
+    int getResourceBlockStride() const { return resourceBlockStride; }
+    int getSlotStride() const { return slotStride; }
+    b getCellLength() const { return cellLength; }
+
+    int getSlotIndex(int subframeIndex, int slotIndex) const { return mode.getSlotIndex(subframeIndex, slotIndex); }
+    bool isSlotAllocated(int slotIndex) const { return slotOffsets[slotIndex] != -1; }
+    bool isSubframeAllocated(int subframeIndex) const;
+
+    /**
+     * Returns the first cell of the given resource block, or -1 if its slot is not yet allocated.
+     */
+    int findResourceBlockCell(int slotIndex, int resourceBlockIndex) const { int offset = slotOffsets[slotIndex]; return offset == -1 ? -1 : offset + resourceBlockIndex * resourceBlockStride; }
+    /**
+     * Returns the first cell of the given resource block, and allocates its slot if necessary.
+     */
+    int getResourceBlockCell(int slotIndex, int resourceBlockIndex) { int offset = slotOffsets[slotIndex]; if (offset == -1) offset = allocateSlot(slotIndex); return offset + resourceBlockIndex * resourceBlockStride; }
+    int findResourceElementCell(int slotIndex, int resourceBlockIndex, int resourceElementIndex) const { ASSERT(levelOfDetail == LevelOfDetail::RESOURCE_ELEMENT); int cell = findResourceBlockCell(slotIndex, resourceBlockIndex); return cell == -1 ? -1 : cell + resourceElementIndex; }
+    int getResourceElementCell(int slotIndex, int resourceBlockIndex, int resourceElementIndex) { ASSERT(levelOfDetail == LevelOfDetail::RESOURCE_ELEMENT); return getResourceBlockCell(slotIndex, resourceBlockIndex) + resourceElementIndex; }
+
+    Ptr<const Chunk> getCellContent(int cell) const { return cell == -1 ? nullptr : isCoarse() ? computeContent(cell, cell + 1) : cellRuns[cell] == -1 ? cells[cell] : getRunContent(cellRuns[cell], cell, cell + 1); }
+    void setCellContent(int cell, const Ptr<const Chunk>& content) { ASSERT(!isCoarse()); cells[cell] = content; cellRuns[cell] = -1; invalidateContents(cell); }
+    /**
+     * Stores the content in as many consecutive cells starting at the given cell as necessary.
+     * The cells must be allocated. At coarse levels of detail, the cells must not be occupied.
+     */
+    void setRunContent(int startCell, const Ptr<const Chunk>& content);
+    /**
+     * Returns the contents of the given consecutive cells, slicing content runs at most once.
+     */
+    Ptr<const Chunk> getContent(int startCell, int endCell) const { return computeContent(startCell, endCell); }
+
+    Ptr<const Chunk> getResourceBlockContent(int slotIndex, int resourceBlockIndex) const;
+    Ptr<const Chunk> getSlotContent(int slotIndex) const;
+    Ptr<const Chunk> getSubframeContent(int subframeIndex) const;
+
+    const std::vector<ResourceAllocation>& getAllocations() const { return allocations; }
+    void addAllocation(const ResourceAllocation& allocation) { allocations.push_back(allocation); }
+
+    /**
+     * Returns the concatenation of all non-empty cells in the order of slots,
+     * or nullptr if the grid is empty. Only the allocated slots are visited.
+     */
+    Ptr<const Chunk> getFrameContent() const;
+};
+
+/**
+ * Represents multiple subframes. The contents are stored in a resource grid,
+ * the subframe, slot, resource block, and resource element objects are views.
+ * Copies of a frame share the same grid until one of them is modified, so
+ * duplicating a frame takes constant time.
+ */
+class Frame : public Packet {
+  protected:
+    std::shared_ptr<ResourceGrid> grid; // shared between copies, copied on write
+    int slotIndex = -1; // the only slot carried by the frame if it's sent in a separate signal, -1 means all slots
+    std::vector<bool> erroneousResourceBlocks; // indexed by slot and resource block, empty if none of them is erroneous
+
+  public:
+    int getSubframesArraySize() const { return grid->getLevelOfDetail() >= LevelOfDetail::SUBFRAME ? grid->getMode().getNumSubframesPerFrame() : 0; } // only for class descriptor
+    Subframe *getSubframePtr(int index) { return grid->getSubframeView(index); } // only for class descriptor
+
+  public:
+    Frame(const LteMode& mode, LevelOfDetail levelOfDetail, int slotIndex = -1) : grid(std::make_shared<ResourceGrid>(mode, levelOfDetail)), slotIndex(slotIndex) { setDuration(slotIndex == -1 ? mode.getFrameDuration() : mode.getSlotDuration()); }
+    Frame(const Frame& other) : Packet(other), grid(other.grid), slotIndex(other.slotIndex), erroneousResourceBlocks(other.erroneousResourceBlocks) { }
+    Frame(const char *name, const Ptr<const Chunk>& content) : Packet(name, content), grid(std::make_shared<ResourceGrid>(LteMode(), LevelOfDetail::RESOURCE_BLOCK)) { setDuration(grid->getMode().getFrameDuration()); }
+    void operator=(const Frame& other) { Packet::operator=(other); grid = other.grid; slotIndex = other.slotIndex; erroneousResourceBlocks = other.erroneousResourceBlocks; }
+
+    virtual Frame *dup() const override { return new Frame(*this); }
+
+    const ResourceGrid& getGrid() const { return *grid; }
+    /**
+     * Returns the grid for modification, the grid is copied first if it's shared with other frames.
+     */
+    ResourceGrid& getGridForUpdate() { if (grid.use_count() > 1) grid = std::make_shared<ResourceGrid>(*grid); return *grid; }
+    /**
+     * Returns a read-only view of the subframe, which doesn't copy a shared grid.
+     */
+    Subframe getSubframe(int index) const { return Subframe(grid.get(), nullptr, index); }
+    /**
+     * Returns a modifiable view of the subframe, the grid is copied on the first write if it's shared at that time.
+     */
+    Subframe getSubframeForUpdate(int index) { return Subframe(nullptr, this, index); }
+    int getSlotIndex() const { return slotIndex; }
+    /**
+     * Returns the time from the beginning of the frame structure to the beginning of the signal.
+     */
+    simtime_t getSignalOffset() const { return slotIndex == -1 ? 0 : grid->getMode().getSlotDuration() * slotIndex; }
+    bool isResourceBlockErroneous(int slotIndex, int resourceBlockIndex) const { return !erroneousResourceBlocks.empty() && erroneousResourceBlocks[slotIndex * grid->getMode().getNumResourceBlocksPerSlot() + resourceBlockIndex]; }
+    void setErroneousResourceBlocks(const std::vector<bool>& erroneousResourceBlocks) { this->erroneousResourceBlocks = erroneousResourceBlocks; }
+    Ptr<const Chunk> getContent() const { return peekAll(); }
+    void setContent(Ptr<const Chunk> content) { removeAll(); insertAtBack(content); }
+};
+
+inline const ResourceGrid *ResourceGridView::getGrid() const { return frame != nullptr ? &frame->getGrid() : grid; }
+inline ResourceGrid *ResourceGridView::getGridForUpdate() const { if (frame == nullptr) throw cRuntimeError("Cannot modify the resource grid through a read-only view"); return &frame->getGridForUpdate(); }
+
+inline Ptr<const Chunk> ResourceElement::getContent() const { auto grid = getGrid(); return grid->getCellContent(grid->findResourceElementCell(slotIndex, resourceBlockIndex, resourceElementIndex)); }
+inline void ResourceElement::setContent(Ptr<const Chunk> content) { auto grid = getGridForUpdate(); grid->setCellContent(grid->getResourceElementCell(slotIndex, resourceBlockIndex, resourceElementIndex), content); }
+
+inline int ResourceBlock::getResourceElementsArraySize() const { return getGrid()->getLevelOfDetail() > LevelOfDetail::RESOURCE_BLOCK ? getGrid()->getMode().getNumResourceElementsPerResourceBlock() : 0; }
+inline ResourceElement *ResourceBlock::getResourceElementPtr(int index) { return getGrid()->getResourceElementView(slotIndex, resourceBlockIndex, index); }
+inline Ptr<const Chunk> ResourceBlock::getContent() const { return getGrid()->getResourceBlockContent(slotIndex, resourceBlockIndex); }
+inline void ResourceBlock::setContent(Ptr<const Chunk> content) { auto grid = getGridForUpdate(); ASSERT(grid->getLevelOfDetail() == LevelOfDetail::RESOURCE_BLOCK); grid->setCellContent(grid->getResourceBlockCell(slotIndex, resourceBlockIndex), content); }
+
+inline int Slot::getResourceBlocksArraySize() const { return getGrid()->getLevelOfDetail() >= LevelOfDetail::RESOURCE_BLOCK ? getGrid()->getMode().getNumResourceBlocksPerSlot() : 0; }
+inline ResourceBlock *Slot::getResourceBlockPtr(int index) { return getGrid()->getResourceBlockView(slotIndex, index); }
+inline Ptr<const Chunk> Slot::getContent() const { return getGrid()->getSlotContent(slotIndex); }
+
+inline int Subframe::getSlotsArraySize() const { return getGrid()->getLevelOfDetail() >= LevelOfDetail::SLOT ? getGrid()->getMode().getNumSlotsPerSubframe() : 0; }
+inline Slot *Subframe::getSlotPtr(int index) { return getGrid()->getSlotView(getGrid()->getSlotIndex(subframeIndex, index)); }
+inline Slot Subframe::getSlot(int index) const { return Slot(grid, frame, getGrid()->getSlotIndex(subframeIndex, index)); }
+inline Ptr<const Chunk> Subframe::getContent() const { return getGrid()->getSubframeContent(subframeIndex); }
+
 /**
  * Implements the INET transmission.
  */
 class LteTransmission : public NarrowbandTransmissionBase, public IScalarSignal {
   protected:
-    W power;
+    W power; // evenly distributed among all resource blocks
+    Hz minFrequency; // lower bound of the allocated resource blocks
+    Hz maxFrequency; // upper bound of the allocated resource blocks
 
   public:
-    LteTransmission(const IRadio *transmitter, const Packet *packet, const simtime_t startTime, const simtime_t endTime, const Coord startPosition, const Coord endPosition, const EulerAngles startOrientation, const EulerAngles endOrientation) :
-        NarrowbandTransmissionBase(transmitter, packet, startTime, endTime, 0, 0, startTime - endTime, startPosition, endPosition, startOrientation, endOrientation, nullptr, Hz(NaN), Hz(NaN)) {}
+    LteTransmission(const IRadio *transmitter, const Packet *packet, const simtime_t startTime, const simtime_t endTime, const Coord startPosition, const Coord endPosition, const EulerAngles startOrientation, const EulerAngles endOrientation, W power, Hz carrierFrequency, Hz bandwidth, Hz minFrequency, Hz maxFrequency) :
+        NarrowbandTransmissionBase(transmitter, packet, startTime, endTime, 0, 0, endTime - startTime, startPosition, endPosition, startOrientation, endOrientation, nullptr, carrierFrequency, bandwidth), power(power), minFrequency(minFrequency), maxFrequency(maxFrequency) {}
 
     virtual W computeMinPower(simtime_t startTime, simtime_t endTime) const { return power; }
     virtual W getPower() const override { return power; }
+    Hz getMinFrequency() const { return minFrequency; }
+    Hz getMaxFrequency() const { return maxFrequency; }
 };
 
 /**
  * Implements the INET transmitter.
  */
 class LteTransmitter : public TransmitterBase {
+  protected:
+    W power = W(NaN);
+    Hz carrierFrequency = Hz(NaN);
+
+  protected:
+    virtual void initialize(int stage) override;
+
   public:
     virtual const ITransmission *createTransmission(const IRadio *transmitter, const Packet *packet, const simtime_t startTime) const override;
 };
 
+class LteErrorModel;
+
 /**
  * Implements the INET receiver.
  */
 class LteReceiver : public ReceiverBase {
+  protected:
+    double snirThreshold = NaN;
+    const LteErrorModel *errorModel = nullptr;
+    uint64_t randomSeed = 0; // for the counter based random numbers
+
+  protected:
+    virtual void initialize(int stage) override;
+
+    /**
+     * Returns a uniform random number in [0, 1) which only depends on the seed of the receiver, the transmission,
+     * and the resource block, so it doesn't depend on the order in which the receptions are evaluated.
+     */
+    double computeUniform(int transmissionId, int resourceBlockIndex) const;
+
+    /**
+     * Computes the SNIR of every resource block of the received frame indexed by slot and resource block. The
+     * reception power is evenly distributed among the resource blocks, and interfering signals contribute
+     * according to their overlap with the time and frequency boundaries of the individual resource blocks. Other
+     * LTE frames only interfere with their allocated resource blocks.
+     */
+    void computeResourceBlockSnirs(const IReception *reception, const IInterference *interference, std::vector<double>& snirs) const;
+
+    /**
+     * Adds the interference power to the overlapping resource blocks of a frame which starts at the given time
+     * and frequency. The interference power is averaged over the duration and the bandwidth of the resource blocks.
+     */
+    void addInterference(std::vector<double>& interferencePowers, const LteMode& mode, double startTime, double minFrequency, double interferenceStartTime, double interferenceEndTime, double interferenceMinFrequency, double interferenceMaxFrequency, double interferencePower) const;
+
   public:
+    /**
+     * Marks the resource blocks of the received frame erroneous whose SNIR is below the threshold. The other
+     * allocated resource blocks are erroneous randomly according to their block error rate if there's an error
+     * model. Doesn't use the simulation kernel, so it can run on worker threads.
+     */
+    void computeErroneousResourceBlocks(const IReception *reception, const IInterference *interference, std::vector<bool>& erroneousResourceBlocks) const;
+
+    /**
+     * Marks the erroneous resource blocks of the frame for the given resource block SNIRs the same way. The
+     * transmission id only selects the random numbers.
+     */
+    void computeErroneousResourceBlocks(const Frame *frame, int transmissionId, const std::vector<double>& snirs, std::vector<bool>& erroneousResourceBlocks) const;
+
     virtual const IListening *createListening(const IRadio *radio, const simtime_t startTime, const simtime_t endTime, const Coord startPosition, const Coord endPosition) const override;
     virtual const IListeningDecision *computeListeningDecision(const IListening *listening, const IInterference *interference) const override;
+    /**
+     * Only the frames carrying resource blocks for the receiving radio can be received, signals of other
+     * technologies only interfere.
+     */
+    virtual bool computeIsReceptionPossible(const IListening *listening, const IReception *reception, IRadioSignal::SignalPart part) const override;
+    /**
+     * Always succeeds, because the errors are determined per resource block in computeReceptionResult.
+     */
     virtual bool computeIsReceptionSuccessful(const IListening *listening, const IReception *reception, IRadioSignal::SignalPart part, const IInterference *interference, const ISnir *snir) const override;
+    /**
+     * Marks the erroneous resource blocks of the received frame, which may have been already evaluated by the
+     * radio medium in parallel with the other receptions of the transmission.
+     */
+    virtual const IReceptionResult *computeReceptionResult(const IListening *listening, const IReception *reception, const IInterference *interference, const ISnir *snir, const std::vector<const IReceptionDecision *> *decisions) const override;
+};
+
+/**
+ * Represents an entry of the CQI table of 3GPP TS 36.213 together with the
+ * SNIR where the block error rate of its modulation and coding is 10% in
+ * AWGN channel.
+ */
+class LteCqi {
+  public:
+    LteModulation modulation;
+    int codeRate; // in 1/1024 units
+    double referenceSnir; // in dB
 };
 
 /**
- * Implements the INET error model.
+ * Implements the INET error model with coded block error rate curves. The
+ * SNIR of the 10% block error rate is taken from the CQI table for the
+ * modulation and code rate of the frame, code rates between two CQIs of the
+ * same modulation are interpolated. The block error rate falls off around
+ * that point along the same turbo coded AWGN curve for all CQIs, which is
+ * tabulated once and shared by all error models.
  */
 class LteErrorModel : public ErrorModelBase {
-    virtual double computePacketErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const override { return NaN; }
-    virtual double computeBitErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const override { return NaN; }
-    virtual double computeSymbolErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const override { return NaN; }
+  protected:
+    virtual void initialize(int stage) override;
+
+    /**
+     * Returns the block error rate curve sampled by SNIR relative to the reference SNIR of the CQIs.
+     */
+    static const std::vector<double>& getBlockErrorRateTable();
+
+  public:
+    /**
+     * Returns the SNIR in dB where the block error rate of the modulation and code rate is 10%.
+     */
+    static double computeReferenceSnir(LteModulation modulation, int codeRate);
+    /**
+     * Interpolates the block error rate of a resource block linearly in dB, the SNIR is clamped to the table.
+     * The reference SNIR is computed once per frame, so only the resource blocks which are asked for are looked up.
+     */
+    double lookupBlockErrorRate(double referenceSnir, double snir) const;
+    /**
+     * Computes the block error rate of a block of the given number of bits assuming that the resource blocks
+     * it spans are erroneous independently.
+     */
+    double computeBlockErrorRate(const LteMode& mode, double snir, b length) const;
+
+    virtual double computePacketErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const override;
+    virtual double computeBitErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const override;
+    virtual double computeSymbolErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const override;
+};
+
+class ILteScheduler;
+class FrameTraceWriter;
+class FrameTraceReader;
+class WorkerPool;
+
+/**
+ * Represents an upper layer packet waiting for transmission. The part before
+ * the offset has already been sent in previous frames.
+ */
+class QueuedPacket {
+  public:
+    Packet *packet = nullptr;
+    b offset = b(0);
+};
+
+/**
+ * Represents the already received segments of an upper layer packet.
+ */
+class PartialPacket {
+  public:
+    std::vector<Ptr<const Chunk>> chunks;
+    b length = b(0);
+    int numSegments = 0; // received so far
+};
+
+/**
+ * Emits the wallclock time elapsed during its lifetime as a signal, but only
+ * if it's enabled, otherwise it doesn't even read the clock.
+ */
+class WallclockTimer {
+  protected:
+    cComponent *component;
+    simsignal_t signal;
+    std::chrono::steady_clock::time_point startTime;
+
+  public:
+    WallclockTimer(cComponent *component, simsignal_t signal, bool enabled) : component(enabled ? component : nullptr), signal(signal) { if (enabled) startTime = std::chrono::steady_clock::now(); }
+    ~WallclockTimer() { if (component != nullptr) component->emit(signal, std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count()); }
 };
 
 /**
@@ -239,29 +705,220 @@ class LteRadio : public Radio {
   protected:
     LteMode mode;
     LevelOfDetail levelOfDetail = LevelOfDetail::RESOURCE_BLOCK;
-    std::vector<AllocatedResourceBlock> allocatedResourceBlocks;
-
-  public:
-    LteRadio();
+    ILteScheduler *scheduler = nullptr;
+
+    bool splitSignals = false;
+    int timerSamplingInterval = 0; // every nth call of the timed methods is measured, 0 means disabled
+    long numTimedTransmitFrameCalls = 0;
+    long numTimedSendUpCalls = 0;
+
+    cMessage *frameTimer = nullptr;
+    FrameTraceWriter *frameTraceWriter = nullptr; // records the transmitted frames if set
+    FrameTraceReader *frameTraceReader = nullptr; // replays the recorded frames if set
+    cMessage *replayTimer = nullptr;
+    double replaySnir = NaN; // of every resource block of the replayed frames
+    int numReplayedFrames = 0;
+    bool isReplayingFrame = false; // while the replayed frame is sent up
+    std::map<simtime_t, Frame *> pendingFrames; // waiting for transmission by start time
+    std::map<MacAddress, std::deque<QueuedPacket>> txQueues; // per destination
+    std::map<std::pair<MacAddress, MacAddress>, PartialPacket> partialPackets; // per source and destination
+    bool isRadioModeDeferred = false;
+    RadioMode deferredRadioMode = RADIO_MODE_OFF; // requested while there were pending transmissions
 
   protected:
+    virtual void initialize(int stage) override;
+
+    virtual void handleSelfMessage(cMessage *message) override;
     virtual void handleUpperPacket(Packet *packet) override;
+    virtual void endTransmission() override;
     virtual void sendUp(Packet *packet) override;
 
+    simtime_t getNextSubframeTime() const { auto subframeDuration = mode.getSubframeDuration(); return subframeDuration * ceil(simTime() / subframeDuration); }
+    bool hasPendingTransmissions() const { return !txQueues.empty() || !pendingFrames.empty(); }
+    bool isTimerSampled(long& numTimedCalls) const { return timerSamplingInterval != 0 && ++numTimedCalls % timerSamplingInterval == 0; }
+
+    /**
+     * Creates a frame from the queued packets according to the scheduler's decision, and starts transmitting it.
+     * Packets which don't fit into the frame are continued in the next one. If signals are split, a separate
+     * frame is created for each slot, and they are transmitted one after the other.
+     */
+    void transmitFrame();
+    void transmitPendingFrame();
+
+    /**
+     * Inserts the content of the allocation into the frames of the slots of its resource blocks, and adds the
+     * corresponding part of the allocation to each of them.
+     */
+    void insertAllocationIntoSlotFrames(const Packet& aggregate, const ResourceAllocation& allocation, std::vector<Frame *>& frames);
+
+    /**
+     * Appends the segments of the content to the partial packets of the allocation, and sends up the completed ones.
+     */
+    void receiveSegments(const ResourceAllocation& allocation, const std::vector<Ptr<const Chunk>>& chunks);
+
+    /**
+     * Reconstructs the next recorded frame with placeholder content of the recorded lengths, and passes it to
+     * the receive path. The received packets are dropped instead of being sent to the upper layers.
+     */
+    void replayFrame();
+
+  public:
+    static simsignal_t resourceBlockUtilizationSignal;
+    static simsignal_t frameLengthSignal;
+    static simsignal_t packetSegmentsSignal;
+    static simsignal_t packetChunksSignal;
+    static simsignal_t transmitFrameTimeSignal;
+    static simsignal_t sendUpTimeSignal;
+
+  public:
+    virtual ~LteRadio();
+
+    /**
+     * Creates an empty frame, which is sent in a separate signal if the slot index is not -1. The frame operations
+     * are static, so they can be used without a radio, e.g. by the benchmarks.
+     */
+    static Frame *createFrame(const LteMode& mode, LevelOfDetail levelOfDetail, int slotIndex);
+
     /**
      * Inserts a part of the packet's content into the resource blocks of the given frame according to the allocation.
      */
-    void insertPacketIntoFrame(const Packet& packet, b offset, b length, Frame& frame, const std::vector<AllocatedResourceBlock>& allocatedResourceBlocks);
+    static void insertPacketIntoFrame(const Packet& packet, b offset, b length, Frame& frame, const std::vector<AllocatedResourceBlock>& allocatedResourceBlocks);
 
     /**
      * Extracts a packet from the resource blocks of the given frame according to the allocation.
      */
-    Packet *extractPacketFromFrame(Frame& frame, const std::vector<AllocatedResourceBlock>& allocatedResourceBlocks);
+    static Packet *extractPacketFromFrame(const Frame& frame, const std::vector<AllocatedResourceBlock>& allocatedResourceBlocks);
+
+    /**
+     * Extracts the content from the resource blocks of the given frame according to the allocation. The content
+     * of erroneous resource blocks is marked incorrect.
+     */
+    static void extractContentFromFrame(const Frame& frame, const std::vector<AllocatedResourceBlock>& allocatedResourceBlocks, std::vector<Ptr<const Chunk>>& chunks);
+
+    /**
+     * Returns an incorrect copy of the chunk.
+     */
+    static Ptr<const Chunk> createIncorrectChunk(const Ptr<const Chunk>& chunk);
+
+    /**
+     * Creates a packet from the chunks replacing slices which cover a whole chunk with the chunk itself.
+     * The packet has bit errors if any of the chunks is incorrect.
+     */
+    static Packet *createPacket(const std::vector<Ptr<const Chunk>>& chunks);
+
+    /**
+     * Appends the content to the chunks flattening sequence chunks. Adjacent slices of the same chunk are merged,
+     * and a slice covering the whole chunk is replaced with the chunk itself. This way the original chunks, along
+     * with their region tags, are restored.
+     */
+    static void appendContent(std::vector<Ptr<const Chunk>>& chunks, const Ptr<const Chunk>& content);
+
+    /**
+     * Computes the frame content from the occupied cells of the frame. The resource block, slot, and
+     * subframe contents are not computed here, the grid computes them on demand.
+     */
+    static void computeFrameContent(Frame& frame);
+
+    /**
+     * The MAC switches the radio out of transmitter mode at the end of every transmission, but the radio stays
+     * in transmitter mode until the queued data and the pending frames are all transmitted. The requested mode
+     * is applied afterwards.
+     */
+    virtual void setRadioMode(RadioMode newRadioMode) override;
+
+    /**
+     * Returns the MAC address of the network interface, or the unspecified address if it's not known.
+     */
+    MacAddress getAddress() const;
+};
+
+/**
+ * Represents an ongoing transmission in the interference index of the radio medium.
+ */
+class IndexedTransmission {
+  public:
+    const ITransmission *transmission = nullptr;
+    int transmissionId = -1;
+    double startTime = NaN; // in seconds
+    double endTime = NaN; // in seconds, including the maximum propagation delay
+    double minFrequency = NaN; // in Hz, NaN means the whole spectrum
+    double maxFrequency = NaN; // in Hz, NaN means the whole spectrum
+    Coord position;
+};
+
+/**
+ * Represents a reception which was evaluated by the radio medium before it ended.
+ */
+class EvaluatedReception {
+  public:
+    simtime_t endTime = -1;
+    const IInterference *interference = nullptr; // owned until it is handed over to the communication cache
+    std::vector<bool> erroneousResourceBlocks;
+};
+
+/**
+ * Implements the INET radio medium with an interference index. The ongoing
+ * transmissions are indexed by time interval and transmitter position, so
+ * interference computation only visits the transmissions which overlap the
+ * listening window, the interference range, and the allocated resource blocks.
+ * The remaining transmissions are still checked by the base class. The
+ * transmissions are removed from the index when the base class removes them.
+ *
+ * If worker threads are configured, the receptions are evaluated in parallel.
+ * All receptions of a transmission are evaluated together when the first of
+ * them ends, with the interference known at that time. The interference is
+ * handed over to the communication cache, so the receiver doesn't compute it
+ * again. A transmission starting before a reception ends invalidates its
+ * evaluation, and the receiver computes it serially.
+ */
+class LteRadioMedium : public RadioMedium {
+  protected:
+    bool indexTransmissions = false;
+    double interferenceRange = NaN; // in meters, NaN means unlimited
+    double maxPropagationDelay = NaN; // in seconds
+    double indexTimeStep = NaN; // in seconds
+    std::map<long, std::map<std::pair<int, int>, std::vector<IndexedTransmission>>> index; // by time step and spatial cell
+    WorkerPool *workerPool = nullptr; // only if receptions are evaluated in parallel
+    mutable std::map<simtime_t, std::vector<std::pair<const IRadio *, const ITransmission *>>> pendingReceptions; // by the first arrival end time of the transmission
+    mutable std::map<std::pair<int, int>, EvaluatedReception> evaluatedReceptions; // by radio and transmission id
+
+  protected:
+    virtual void initialize(int stage) override;
+
+    std::pair<int, int> getCell(const Coord& position) const;
+    IndexedTransmission createIndexedTransmission(const ITransmission *transmission) const;
+    void removeIndexedTransmission(const ITransmission *transmission);
+
+    /**
+     * Collects the indexed transmissions which overlap the listening in time, space and the given frequency
+     * range. Only the index buckets overlapping the listening are visited, and the result is ordered by
+     * transmission id like the transmissions of the base class.
+     */
+    void collectInterferingTransmissions(const IListening *listening, double minFrequency, double maxFrequency, std::vector<const ITransmission *>& interferingTransmissions) const;
+
+    virtual const IInterference *computeInterference(const IRadio *receiver, const IListening *listening, const std::vector<const ITransmission *> *transmissions) const override;
+    virtual const IInterference *computeInterference(const IRadio *receiver, const IListening *listening, const ITransmission *transmission, const std::vector<const ITransmission *> *transmissions) const override;
+
+    /**
+     * Evaluates the pending receptions of all transmissions whose first reception ends by now. The reception
+     * possibility and the erroneous resource blocks are computed on the worker threads, the listenings,
+     * receptions and interferences on the simulation thread. The results are stored by radio and transmission
+     * until the receptions end.
+     */
+    void evaluateReceptions() const;
+    void invalidateEvaluatedReceptions(const ITransmission *transmission);
+
+  public:
+    virtual ~LteRadioMedium();
+
+    virtual void addTransmission(const IRadio *transmitter, const ITransmission *transmission) override;
+    virtual void receiveSignal(cComponent *source, simsignal_t signal, cObject *value, cObject *details) override;
+    virtual const IInterference *getInterference(const IRadio *receiver, const ITransmission *transmission) const override;
 
     /**
-     * Computes all frame, subframe, slot, and resource block contents based on resource element contents.
+     * Moves the erroneous resource blocks of the reception to the result if they were evaluated in parallel.
      */
-    void computeFrameContent(Frame& frame);
+    bool takeErroneousResourceBlocks(const IRadio *receiver, const ITransmission *transmission, std::vector<bool>& erroneousResourceBlocks) const;
 };
 
 } // namespace lte
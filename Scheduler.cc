@@ -0,0 +1,123 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include <algorithm>
+#include <queue>
+#include "Scheduler.h"
+
+namespace lte {
+
+Define_Module(LteRoundRobinScheduler);
+Define_Module(LteProportionalFairScheduler);
+
+void LteSchedulerBase::scheduleFrame(const LteMode& mode, std::vector<LteDemand>& demands)
+{
+    int numResourceBlockPairs = mode.getNumResourceBlocksPerSlot();
+    b resourceBlockPairLength = mode.getResourceBlockLength() * mode.getNumSlotsPerSubframe();
+    std::vector<int> numRequiredPairs(demands.size());
+    std::vector<int> numAssignedPairs(demands.size());
+    for (int i = 0; i < mode.getNumSubframesPerFrame(); i++) {
+        bool hasDemand = false;
+        for (size_t j = 0; j < demands.size(); j++) {
+            numRequiredPairs[j] = (demands[j].length.get() + resourceBlockPairLength.get() - 1) / resourceBlockPairLength.get();
+            numAssignedPairs[j] = 0;
+            hasDemand |= numRequiredPairs[j] > 0;
+        }
+        if (!hasDemand)
+            break;
+        scheduleSubframe(i, numResourceBlockPairs, demands, numRequiredPairs, numAssignedPairs);
+        // the pairs of a demand are contiguous in frequency, and they are listed slot by slot
+        int resourceBlockIndex = 0;
+        for (size_t j = 0; j < demands.size(); j++) {
+            auto& demand = demands[j];
+            int numPairs = numAssignedPairs[j];
+            for (int k = 0; k < mode.getNumSlotsPerSubframe(); k++) {
+                for (int l = 0; l < numPairs; l++) {
+                    AllocatedResourceBlock allocatedResourceBlock;
+                    allocatedResourceBlock.subframeIndex = i;
+                    allocatedResourceBlock.slotIndex = k;
+                    allocatedResourceBlock.resourceBlockIndex = resourceBlockIndex + l;
+                    demand.allocatedResourceBlocks.push_back(allocatedResourceBlock);
+                }
+            }
+            resourceBlockIndex += numPairs;
+            auto allocatedLength = resourceBlockPairLength * numPairs;
+            demand.length = allocatedLength < demand.length ? demand.length - allocatedLength : b(0);
+        }
+        if (resourceBlockIndex > numResourceBlockPairs)
+            throw cRuntimeError("Scheduler assigned more resource block pairs than available");
+    }
+}
+
+void LteRoundRobinScheduler::scheduleSubframe(int subframeIndex, int numResourceBlockPairs, const std::vector<LteDemand>& demands, const std::vector<int>& numRequiredPairs, std::vector<int>& numAssignedPairs)
+{
+    // order the demands by the subframe they were last served in, never served ones first
+    std::vector<std::pair<long, int>> order;
+    for (size_t i = 0; i < demands.size(); i++) {
+        if (numRequiredPairs[i] > 0) {
+            auto it = lastServedSubframes.find(demands[i].destination);
+            order.push_back(std::make_pair(it != lastServedSubframes.end() ? it->second : -1, i));
+        }
+    }
+    std::sort(order.begin(), order.end());
+    int numRemainingPairs = numResourceBlockPairs;
+    size_t numServedDemands = singleDemandPerSubframe ? std::min(order.size(), (size_t)1) : order.size();
+    for (size_t i = 0; i < numServedDemands && numRemainingPairs > 0; i++) {
+        int demandIndex = order[i].second;
+        int share = std::max(1, numRemainingPairs / (int)(numServedDemands - i));
+        int numPairs = std::min(share, numRequiredPairs[demandIndex]);
+        numAssignedPairs[demandIndex] = numPairs;
+        numRemainingPairs -= numPairs;
+        lastServedSubframes[demands[demandIndex].destination] = numScheduledSubframes;
+    }
+    numScheduledSubframes++;
+}
+
+void LteProportionalFairScheduler::initialize()
+{
+    averagingFactor = par("averagingFactor");
+}
+
+void LteProportionalFairScheduler::scheduleSubframe(int subframeIndex, int numResourceBlockPairs, const std::vector<LteDemand>& demands, const std::vector<int>& numRequiredPairs, std::vector<int>& numAssignedPairs)
+{
+    // the queue is ordered by the projected average throughput, ties are broken by the demand index
+    typedef std::pair<double, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    for (size_t i = 0; i < demands.size(); i++)
+        if (numRequiredPairs[i] > 0)
+            queue.push(Entry(averageThroughputs[demands[i].destination], i));
+    if (singleDemandPerSubframe) {
+        if (!queue.empty()) {
+            int demandIndex = queue.top().second;
+            numAssignedPairs[demandIndex] = std::min(numRequiredPairs[demandIndex], numResourceBlockPairs);
+        }
+    }
+    else {
+        for (int i = 0; i < numResourceBlockPairs && !queue.empty(); i++) {
+            auto entry = queue.top();
+            queue.pop();
+            int demandIndex = entry.second;
+            if (++numAssignedPairs[demandIndex] < numRequiredPairs[demandIndex])
+                queue.push(Entry(entry.first + averagingFactor, demandIndex));
+        }
+    }
+    for (auto& it : averageThroughputs)
+        it.second *= 1 - averagingFactor;
+    for (size_t i = 0; i < demands.size(); i++)
+        averageThroughputs[demands[i].destination] += averagingFactor * numAssignedPairs[i];
+}
+
+} // namespace lte
+
@@ -0,0 +1,107 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __LTE_SCHEDULER_H_
+#define __LTE_SCHEDULER_H_
+
+#include "inet/linklayer/common/MacAddress.h"
+#include "Phy.h"
+
+namespace lte {
+
+/**
+ * Represents the data waiting for transmission towards one destination.
+ */
+class LteDemand {
+  public:
+    MacAddress destination;
+    b length = b(0); // the part that doesn't have resource blocks yet
+    std::vector<AllocatedResourceBlock> allocatedResourceBlocks;
+};
+
+/**
+ * Interface for MAC schedulers which allocate the resource blocks of a frame.
+ */
+class ILteScheduler {
+  public:
+    virtual ~ILteScheduler() { }
+
+    /**
+     * Allocates the resource blocks of a frame to the demands subframe by subframe. The allocated resource blocks
+     * are appended to the demands, and the lengths of the demands are decreased accordingly.
+     */
+    virtual void scheduleFrame(const LteMode& mode, std::vector<LteDemand>& demands) = 0;
+
+    /**
+     * Restricts every subframe to a single demand, so the signal of a slot is addressed to one destination.
+     */
+    virtual void setSingleDemandPerSubframe(bool singleDemandPerSubframe) = 0;
+};
+
+/**
+ * Base class for schedulers which allocate resource block pairs, that is the
+ * same resource block in all slots of a subframe, in every TTI.
+ */
+class LteSchedulerBase : public cSimpleModule, public ILteScheduler {
+  protected:
+    bool singleDemandPerSubframe = false;
+
+  protected:
+    /**
+     * Decides how many resource block pairs of the subframe each demand gets. The number of resource block pairs
+     * still required by the demands is given, the sum of the assigned pairs must not exceed the available ones.
+     * Only one demand may get pairs if the subframe is restricted to a single demand.
+     */
+    virtual void scheduleSubframe(int subframeIndex, int numResourceBlockPairs, const std::vector<LteDemand>& demands, const std::vector<int>& numRequiredPairs, std::vector<int>& numAssignedPairs) = 0;
+
+  public:
+    virtual void scheduleFrame(const LteMode& mode, std::vector<LteDemand>& demands) override;
+    virtual void setSingleDemandPerSubframe(bool singleDemandPerSubframe) override { this->singleDemandPerSubframe = singleDemandPerSubframe; }
+};
+
+/**
+ * Serves the least recently served demands first, and divides the resource
+ * block pairs of the subframe equally among them. If the subframe is
+ * restricted to a single demand, the least recently served one gets all.
+ */
+class LteRoundRobinScheduler : public LteSchedulerBase {
+  protected:
+    long numScheduledSubframes = 0;
+    std::map<MacAddress, long> lastServedSubframes;
+
+  protected:
+    virtual void scheduleSubframe(int subframeIndex, int numResourceBlockPairs, const std::vector<LteDemand>& demands, const std::vector<int>& numRequiredPairs, std::vector<int>& numAssignedPairs) override;
+};
+
+/**
+ * Assigns each resource block pair of the subframe to the demand with the
+ * lowest projected average throughput. Without channel quality information
+ * all destinations have the same achievable rate, so this is the proportional
+ * fair metric. If the subframe is restricted to a single demand, the demand
+ * with the lowest average throughput gets all.
+ */
+class LteProportionalFairScheduler : public LteSchedulerBase {
+  protected:
+    double averagingFactor = NaN;
+    std::map<MacAddress, double> averageThroughputs; // exponentially averaged resource block pairs per subframe
+
+  protected:
+    virtual void initialize() override;
+    virtual void scheduleSubframe(int subframeIndex, int numResourceBlockPairs, const std::vector<LteDemand>& demands, const std::vector<int>& numRequiredPairs, std::vector<int>& numAssignedPairs) override;
+};
+
+} // namespace lte
+
+#endif // __LTE_SCHEDULER_H_
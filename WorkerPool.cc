@@ -0,0 +1,91 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+#include "WorkerPool.h"
+
+namespace lte {
+
+WorkerPool::WorkerPool(int numThreads)
+{
+    for (int i = 1; i < numThreads; i++)
+        threads.push_back(std::thread(&WorkerPool::work, this));
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    tasksAvailable.notify_all();
+    for (auto& thread : threads)
+        thread.join();
+}
+
+void WorkerPool::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        tasksAvailable.wait(lock, [&] () { return stopping || nextTaskIndex < numTasks; });
+        if (stopping)
+            return;
+        executeTasks(lock);
+    }
+}
+
+void WorkerPool::executeTasks(std::unique_lock<std::mutex>& lock)
+{
+    while (nextTaskIndex < numTasks) {
+        int i = nextTaskIndex++;
+        lock.unlock();
+        std::exception_ptr taskException;
+        try {
+            task(i);
+        }
+        catch (...) {
+            taskException = std::current_exception();
+        }
+        lock.lock();
+        if (taskException && (exceptionTaskIndex == -1 || i < exceptionTaskIndex)) {
+            exception = taskException;
+            exceptionTaskIndex = i;
+        }
+        if (++numFinishedTasks == numTasks)
+            tasksFinished.notify_all();
+    }
+}
+
+void WorkerPool::run(int numTasks, const std::function<void(int)>& task)
+{
+    if (numTasks == 0)
+        return;
+    std::unique_lock<std::mutex> lock(mutex);
+    this->task = task;
+    this->numTasks = numTasks;
+    nextTaskIndex = 0;
+    numFinishedTasks = 0;
+    exceptionTaskIndex = -1;
+    exception = nullptr;
+    tasksAvailable.notify_all();
+    executeTasks(lock);
+    tasksFinished.wait(lock, [&] () { return numFinishedTasks == this->numTasks; });
+    // prevents the workers from picking up tasks again until the next run
+    this->numTasks = 0;
+    nextTaskIndex = 0;
+    this->task = nullptr;
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+} // namespace lte
@@ -0,0 +1,69 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+#ifndef __LTE_WORKERPOOL_H_
+#define __LTE_WORKERPOOL_H_
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lte {
+
+/**
+ * Runs independent tasks on a fixed set of threads. The tasks must not touch
+ * the simulation kernel, so they are limited to pure numeric computations on
+ * data prepared by the simulation thread, and they must store their results
+ * by task index to keep the simulation deterministic.
+ */
+class WorkerPool {
+  protected:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable tasksAvailable;
+    std::condition_variable tasksFinished;
+    std::function<void(int)> task;
+    int numTasks = 0;
+    int nextTaskIndex = 0;
+    int numFinishedTasks = 0;
+    int exceptionTaskIndex = -1;
+    std::exception_ptr exception;
+    bool stopping = false;
+
+  protected:
+    void work();
+    void executeTasks(std::unique_lock<std::mutex>& lock);
+
+  public:
+    /**
+     * The calling thread also executes tasks, so only numThreads - 1 threads are created.
+     */
+    WorkerPool(int numThreads);
+    ~WorkerPool();
+
+    int getNumThreads() const { return threads.size() + 1; }
+
+    /**
+     * Executes the task for all indices in [0, numTasks) and waits until all of them finish. If some tasks
+     * throw, then the exception of the one with the smallest index is rethrown independently of the timing.
+     */
+    void run(int numTasks, const std::function<void(int)>& task);
+};
+
+} // namespace lte
+
+#endif // __LTE_WORKERPOOL_H_
@@ -0,0 +1,178 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include "inet/common/packet/chunk/ByteCountChunk.h"
+#include "Benchmark.h"
+
+// the benchmark is a separate executable, so counting all allocations of the process is fine
+static uint64_t numAllocations = 0;
+
+void *operator new(size_t size)
+{
+    numAllocations++;
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t size) noexcept
+{
+    std::free(p);
+}
+
+namespace lte {
+
+Define_Module(LteRadioBenchmark);
+
+static const char *levelOfDetailNames[] = { "FRAME", "SUBFRAME", "SLOT", "RESOURCE_BLOCK", "RESOURCE_ELEMENT" };
+static const char *bandwidthNames[] = { "1.4MHz", "3MHz", "5MHz", "10MHz", "15MHz", "20MHz" };
+static const char *cyclicPrefixNames[] = { "normal", "extended" };
+static const char *modulationNames[] = { "QPSK", "QAM-16", "QAM-64" };
+
+static const LteMode benchmarkModes[] = {
+    LteMode(LteBandwidth::MHZ_1_4, LteCyclicPrefix::NORMAL, LteModulation::QAM64),
+    LteMode(LteBandwidth::MHZ_5, LteCyclicPrefix::NORMAL, LteModulation::QAM64),
+    LteMode(LteBandwidth::MHZ_20, LteCyclicPrefix::NORMAL, LteModulation::QAM64),
+    LteMode(LteBandwidth::MHZ_20, LteCyclicPrefix::EXTENDED, LteModulation::QPSK)
+};
+
+void LteRadioBenchmark::initialize()
+{
+    minDuration = par("minDuration");
+    packetLengths = cStringTokenizer(par("packetLengths")).asIntVector();
+    allocationSizes = cStringTokenizer(par("allocationSizes")).asIntVector();
+    const char *outputFile = par("outputFile");
+    output.open(outputFile);
+    if (!output.is_open())
+        throw cRuntimeError("Cannot open output file: %s", outputFile);
+    for (int i = 0; i <= (int)LevelOfDetail::RESOURCE_ELEMENT; i++) {
+        levelOfDetail = (LevelOfDetail)i;
+        for (const auto& benchmarkMode : benchmarkModes) {
+            mode = benchmarkMode;
+            for (int packetLength : packetLengths)
+                for (int allocationSize : allocationSizes)
+                    runBenchmarks(packetLength, allocationSize);
+        }
+    }
+    output.close();
+}
+
+BenchmarkResult LteRadioBenchmark::measure(const std::function<void(int batchSize)>& prepare, const std::function<void(int i)>& operation, const std::function<void()>& cleanup) const
+{
+    long numOperations = 0;
+    uint64_t numOperationAllocations = 0;
+    std::chrono::nanoseconds duration(0);
+    int batchSize = 1;
+    while (duration.count() < minDuration * 1E+9) {
+        prepare(batchSize);
+        uint64_t startAllocations = numAllocations;
+        auto startTime = std::chrono::steady_clock::now();
+        for (int i = 0; i < batchSize; i++)
+            operation(i);
+        auto endTime = std::chrono::steady_clock::now();
+        numOperationAllocations += numAllocations - startAllocations;
+        duration += std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime);
+        numOperations += batchSize;
+        cleanup();
+        batchSize = std::min(batchSize * 2, 1024);
+    }
+    BenchmarkResult result;
+    result.numOperations = numOperations;
+    result.nanosecondsPerOperation = (double)duration.count() / numOperations;
+    result.allocationsPerOperation = (double)numOperationAllocations / numOperations;
+    return result;
+}
+
+void LteRadioBenchmark::runBenchmarks(int packetLength, int allocationSize)
+{
+    if (allocationSize > mode.getNumResourceBlocksPerSlot())
+        return;
+    // the first resource blocks of every slot are allocated until the packet fits
+    b length = B(packetLength);
+    std::vector<AllocatedResourceBlock> allocatedResourceBlocks;
+    b allocatedLength = b(0);
+    for (int i = 0; i < mode.getNumSubframesPerFrame() && allocatedLength < length; i++) {
+        for (int j = 0; j < mode.getNumSlotsPerSubframe() && allocatedLength < length; j++) {
+            for (int k = 0; k < allocationSize; k++) {
+                AllocatedResourceBlock allocatedResourceBlock;
+                allocatedResourceBlock.subframeIndex = i;
+                allocatedResourceBlock.slotIndex = j;
+                allocatedResourceBlock.resourceBlockIndex = k;
+                allocatedResourceBlocks.push_back(allocatedResourceBlock);
+                allocatedLength += mode.getResourceBlockLength();
+            }
+        }
+    }
+    if (allocatedLength < length)
+        return;
+    auto packet = new Packet("BenchmarkPacket", makeShared<ByteCountChunk>(B(packetLength)));
+    auto filledFrame = LteRadio::createFrame(mode, levelOfDetail, -1);
+    LteRadio::insertPacketIntoFrame(*packet, b(0), length, *filledFrame, allocatedResourceBlocks);
+    LteRadio::computeFrameContent(*filledFrame);
+    std::vector<Frame *> frames;
+    auto deleteFrames = [&] () { for (auto frame : frames) delete frame; frames.clear(); };
+    auto createFrames = [&] (int batchSize) { for (int i = 0; i < batchSize; i++) frames.push_back(LteRadio::createFrame(mode, levelOfDetail, -1)); };
+    auto fillFrames = [&] (int batchSize) {
+        createFrames(batchSize);
+        for (auto frame : frames)
+            LteRadio::insertPacketIntoFrame(*packet, b(0), length, *frame, allocatedResourceBlocks);
+    };
+    auto result = measure([&] (int batchSize) { frames.resize(batchSize); },
+                          [&] (int i) { frames[i] = LteRadio::createFrame(mode, levelOfDetail, -1); },
+                          deleteFrames);
+    writeResult("createFrame", packetLength, allocationSize, result);
+    result = measure([&] (int batchSize) { frames.resize(batchSize); },
+                     [&] (int i) { frames[i] = filledFrame->dup(); },
+                     deleteFrames);
+    writeResult("Frame::dup", packetLength, allocationSize, result);
+    result = measure(createFrames,
+                     [&] (int i) { LteRadio::insertPacketIntoFrame(*packet, b(0), length, *frames[i], allocatedResourceBlocks); },
+                     deleteFrames);
+    writeResult("insertPacketIntoFrame", packetLength, allocationSize, result);
+    result = measure(fillFrames,
+                     [&] (int i) { LteRadio::computeFrameContent(*frames[i]); },
+                     deleteFrames);
+    writeResult("computeFrameContent", packetLength, allocationSize, result);
+    // deleting the extracted packet is part of the operation, because the receiver does it too eventually
+    result = measure([&] (int batchSize) { },
+                     [&] (int i) { delete LteRadio::extractPacketFromFrame(*filledFrame, allocatedResourceBlocks); },
+                     [&] () { });
+    writeResult("extractPacketFromFrame", packetLength, allocationSize, result);
+    delete filledFrame;
+    delete packet;
+}
+
+void LteRadioBenchmark::writeResult(const char *operation, int packetLength, int allocationSize, const BenchmarkResult& result)
+{
+    output << "{\"operation\": \"" << operation << "\""
+           << ", \"levelOfDetail\": \"" << levelOfDetailNames[(int)levelOfDetail] << "\""
+           << ", \"channelBandwidth\": \"" << bandwidthNames[(int)mode.getChannelBandwidth()] << "\""
+           << ", \"cyclicPrefix\": \"" << cyclicPrefixNames[(int)mode.getCyclicPrefix()] << "\""
+           << ", \"modulation\": \"" << modulationNames[(int)mode.getModulation()] << "\""
+           << ", \"packetLength\": " << packetLength
+           << ", \"allocationSize\": " << allocationSize
+           << ", \"numOperations\": " << result.numOperations
+           << ", \"nsPerOp\": " << result.nanosecondsPerOperation
+           << ", \"allocsPerOp\": " << result.allocationsPerOperation << "}" << std::endl;
+}
+
+} // namespace lte
@@ -0,0 +1,65 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+#ifndef __LTE_BENCHMARK_H_
+#define __LTE_BENCHMARK_H_
+
+#include <fstream>
+#include <functional>
+#include "Phy.h"
+
+namespace lte {
+
+/**
+ * Represents the measurement of one operation in one configuration.
+ */
+class BenchmarkResult {
+  public:
+    long numOperations = 0;
+    double nanosecondsPerOperation = NaN;
+    double allocationsPerOperation = NaN;
+};
+
+/**
+ * Measures the frame operations of the LTE radio across levels of detail,
+ * LTE modes, packet lengths, and allocation sizes. The operations are static
+ * members of the radio, so no radio module is involved. The results are
+ * written as JSON lines to the output file.
+ */
+class LteRadioBenchmark : public cSimpleModule {
+  protected:
+    LteMode mode;
+    LevelOfDetail levelOfDetail = LevelOfDetail::RESOURCE_BLOCK;
+    double minDuration = NaN; // in seconds, per operation and configuration
+    std::vector<int> packetLengths; // in bytes
+    std::vector<int> allocationSizes; // in resource blocks per slot
+    std::ofstream output;
+
+  protected:
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *message) override { throw cRuntimeError("Unexpected message"); }
+
+    /**
+     * Runs the operation in batches of increasing size until the measured time exceeds the minimum duration.
+     * Only the operations are measured, the preparation and the cleanup of the batches are not.
+     */
+    BenchmarkResult measure(const std::function<void(int batchSize)>& prepare, const std::function<void(int i)>& operation, const std::function<void()>& cleanup) const;
+
+    void runBenchmarks(int packetLength, int allocationSize);
+    void writeResult(const char *operation, int packetLength, int allocationSize, const BenchmarkResult& result);
+};
+
+} // namespace lte
+
+#endif // __LTE_BENCHMARK_H_